@@ -288,6 +288,19 @@
  *
  */
 
+/*
+ *      Defining LZCOMP builds in a block compressor that save and bones
+ *      files go through as they are written and read, so they come out
+ *      small without running an external program after every save.
+ *      Files written without it can still be read, and so can files
+ *      written with it by a build that doesn't define it.  If COMPRESS
+ *      is defined too, the external program is no longer run on files
+ *      being saved but is still used to uncompress any old ones left
+ *      compressed by an earlier build.
+ */
+
+#define LZCOMP /* built-in compression of save and bones files */
+
 #if defined(UNIX) && !defined(ZLIB_COMP) && !defined(COMPRESS)
 /* path and file name extension for compression program */
 #define COMPRESS "/usr/bin/compress" /* Lempel-Ziv compression */
@@ -456,17 +469,6 @@ typedef unsigned char uchar;
 
 /* #define STRNCMPI */ /* compiler/library has the strncmpi function */
 
-/*
- * Vision choices.
- *
- * Things will be faster if you can use MACRO_CPATH.  Some cpps, however,
- * cannot deal with the size of the functions that have been macroized.
- */
-
-#ifndef NO_MACRO_CPATH
-#define MACRO_CPATH /* use clear_path macros instead of functions */
-#endif
-
 #if !defined(MAC)
 #if !defined(NOCLIPPING)
 #define CLIPPING /* allow smaller screens -- ERS */
@@ -619,6 +621,9 @@ typedef unsigned char uchar;
 #endif
 
 #define USE_ISAAC64 /* Use cross-plattform, bundled RNG */
+/* #define RNGTRACE */ /* remember the source location behind each of the
+                        * last RNGTRACE_SZ random numbers, for finding where
+                        * a replayed game diverges (see dump_rngtrace()) */
 
 /* End of Section 4 */
 
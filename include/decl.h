@@ -207,6 +207,17 @@ E NEARDATA struct obj *uball;
 #include "engrave.h"
 E struct engr *head_engr;
 
+/* chunk pools (alloc.c) for objects, monsters and their extra data */
+enum nhpool_types {
+    POOL_OBJ = 0, POOL_OEXTRA,
+    POOL_MONST, POOL_MEXTRA, POOL_EGD, POOL_EPRI, POOL_ESHK, POOL_EMIN,
+    POOL_EDOG,
+    NUM_NHPOOLS
+};
+E struct nhpool nhpools[NUM_NHPOOLS];
+#define pool_get(pt) nhpool_get(&nhpools[pt])
+#define pool_put(pt, p) nhpool_put(&nhpools[pt], (genericptr_t) (p))
+
 #include "you.h"
 E NEARDATA struct you u;
 E NEARDATA time_t ubirthday;
@@ -360,7 +371,7 @@ E NEARDATA struct savefile_info sfcap, sfrestinfo, sfsaveinfo;
 
 struct selectionvar {
     int wid, hei;
-    char *map;
+    unsigned long *map; /* one word per column, bit y set if <x,y> is in */
 };
 
 struct autopickup_exception {
@@ -505,6 +516,49 @@ struct val_list {
     int size;
 };
 
+/* rndmonst()'s candidates for the level it last ran on; everything which
+   decides whether a monster type is eligible and what its weight is,
+   apart from genocide and extinction, is part of the key */
+struct rndmonst_cache {
+    d_level lev;
+    int minmlev, maxmlev;
+    int align;              /* dungeon alignment used by align_shift() */
+    boolean valid;
+    int ncand;
+    short mndx[SPECIAL_PM]; /* candidates in mons[] order, weight > 0 */
+    schar weight[SPECIAL_PM];
+    long align_moves;       /* level_align()'s memo: turn it was last */
+    s_level *align_lev;     /*   evaluated and the special level found */
+};
+
+/* the contents of a level file, shared between the snapshots taken while
+   the file was unchanged and the cache of level files in g.snaplevels[] */
+struct snaplevel {
+    int refcnt;
+    size_t len;
+    char *data;
+};
+
+/* a level kept in memory rather than in its level file (files.c) */
+struct levelstore {
+    char *data;             /* savelev() image, or Null if not in memory */
+    size_t len;
+    size_t rawlen;          /* length of the image before compression */
+    unsigned long lastuse;  /* g.lstore_clock when last written or read */
+    boolean ondisk;         /* the level file has this image too */
+    boolean packed;         /* data is compressed (LZCOMP) */
+};
+
+/* the whole game held in memory by snapshot_take(), for putting back with
+   snapshot_restore(); 'state' is what a save file would hold for the game
+   and the current level, levels[] has the other levels' files */
+struct snapshot {
+    char *state;
+    size_t statelen;
+    xchar ledger;           /* current level's ledger number */
+    struct snaplevel *levels[MAXLINFO];
+};
+
 /* at most one of `door' and `box' should be non-null at any given time */
 struct xlock_s {
     struct rm *door;
@@ -557,6 +611,7 @@ typedef struct ls_t {
     short flags;
     short type;  /* type of light source */
     anything id; /* source's identifier */
+    struct ls_footprint *footprint; /* cached lit area; not saved */
 } light_source;
 
 struct container {
@@ -899,6 +954,11 @@ struct instance_globals {
 #endif
     char bones[BONESSIZE];
     char lock[LOCKNAMESIZE];
+    struct levelstore lstore[MAXLINFO];
+    size_t lstore_bytes;        /* memory taken by lstore[].data */
+    unsigned long lstore_clock;
+    int lstore_fd;              /* in-memory level file being written */
+    int lstore_lev;             /*   and the level it's for */
 
     /* hack.c */
     anything tmp_anything;
@@ -928,6 +988,7 @@ struct instance_globals {
     struct xlock_s xlock;
 
     /* makemon.c */
+    struct rndmonst_cache rndmonst_cache;
 
     /* mhitm.c */
     long noisetime;
@@ -964,6 +1025,9 @@ struct instance_globals {
 
     /* mkobj.c */
     boolean mkcorpstat_norevive; /* for trolls */
+    unsigned long floorseq;      /* last o_floorseq handed out */
+    struct obj **area_hits;      /* first_obj_in_area()'s results */
+    int area_hits_size;          /* room in area_hits[] */
 
     /* mon.c */
     boolean vamp_rise_msg;
@@ -995,6 +1059,11 @@ struct instance_globals {
     int lusername_size;
 #endif
 
+    /* nhlua.c */
+    genericptr_t luacore;  /* lua_State reused by load_lua() */
+    char *luacore_nhlib;   /* precompiled nhlib.lua */
+    size_t luacore_nhlib_len;
+
     /* o_init.c */
     short disco[NUM_OBJECTS];
 
@@ -1116,6 +1185,7 @@ struct instance_globals {
     unsigned usteed_id; /* need to preserve during save */
     struct obj *looseball;  /* track uball during save and... */
     struct obj *loosechain; /* track uchain since saving might free it */
+    struct snaplevel *snaplevels[MAXLINFO]; /* level files already read */
 
     /* shk.c */
     /* auto-response flag for/from "sell foo?" 'a' => 'y', 'q' => 'n' */
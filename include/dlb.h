@@ -16,6 +16,10 @@
 #endif
 
 #ifdef DLBLIB
+#if defined(UNIX) && !defined(NO_DLB_MMAP)
+#define DLB_MMAP /* read library files through a shared read-only mapping */
+#endif
+
 /* directory structure in memory */
 typedef struct dlb_directory {
     char *fname;   /* file name as seen from calling code */
@@ -33,6 +37,12 @@ typedef struct dlb_library {
     long nentries; /* # of files in directory */
     long rev;      /* dlb file revision */
     long strsize;  /* dlb file string size */
+    int *hashtab;  /* directory index for each hash slot, -1 if none */
+    int hashsize;  /* # of hash slots, a power of 2 */
+#ifdef DLB_MMAP
+    char *fmap;    /* whole library file if mapped, otherwise null */
+    long fmapsize; /* size of mapping */
+#endif
 } library;
 
 /* library definitions */
@@ -144,4 +154,16 @@ long rsrc_dlb_ftell(dlb *dp);
 #define WRBMODE "w+"
 #endif
 
+/*
+ * Precompiled lua:  util/nhluac stores the compiled form of "foo.lua" as
+ * "foo.luac", which is a stamp line followed by lua_dump()'s output.  If
+ * the stamp doesn't match the running game, the source is used instead.
+ */
+#define LUAC_SUFFIX "c"
+#define LUAC_STAMPFMT "NHluac %d.%d.%d-%d %s\n"
+#define LUAC_STAMPSZ 64
+#define make_luac_stamp(buf)                                            \
+    Sprintf((buf), LUAC_STAMPFMT, VERSION_MAJOR, VERSION_MINOR,         \
+            PATCHLEVEL, EDITLEVEL, LUA_RELEASE)
+
 #endif /* DLB_H */
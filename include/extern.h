@@ -21,6 +21,7 @@ extern char *fmt_ptr(const void *);
 extern void moveloop(boolean);
 extern void stop_occupation(void);
 extern void display_gamewindows(void);
+extern void newgame_setup(void);
 extern void newgame(void);
 extern void welcome(boolean);
 extern time_t get_realtime(void);
@@ -758,6 +759,7 @@ extern void set_levelfile_name(char *, int);
 extern NHFILE *create_levelfile(int, char *);
 extern NHFILE *open_levelfile(int, char *);
 extern void delete_levelfile(int);
+extern void lstore_flush(void);
 extern void clearlocks(void);
 extern NHFILE *create_bonesfile(d_level *, char **, char *);
 extern void commit_bonesfile(d_level *);
@@ -1076,6 +1078,8 @@ extern int dosuspend(void);
 extern void new_light_source(xchar, xchar, int, int, union any *);
 extern void del_light_source(int, union any *);
 extern void do_light_sources(xchar **);
+extern void light_block_changed(int, int);
+extern void reset_light_footprints(void);
 extern void show_transient_light(struct obj *, int, int);
 extern void transient_light_cleanup(void);
 extern struct monst *find_mid(unsigned, unsigned);
@@ -1336,6 +1340,11 @@ extern boolean is_flammable(struct obj *);
 extern boolean is_rottable(struct obj *);
 extern void place_object(struct obj *, int, int);
 extern void remove_object(struct obj *);
+extern void recalc_obj_buckets(void);
+extern void set_obj_class(struct obj *, int);
+extern struct obj *first_obj_in_area(struct obj_area *, int, int, int, int,
+                                     unsigned long);
+extern struct obj *next_obj_in_area(struct obj_area *);
 extern void discard_minvent(struct monst *, boolean);
 extern void obj_extract_self(struct obj *);
 extern void extract_nobj(struct obj *, struct obj **);
@@ -1661,6 +1670,7 @@ extern lua_State * nhl_init(void);
 extern void nhl_done(lua_State *);
 extern boolean nhl_loadlua(lua_State *, const char *);
 extern boolean load_lua(const char *);
+extern void nhl_core_done(void);
 extern void nhl_error(lua_State *, const char *) NORETURN;
 extern void lcheck_param_table(lua_State *);
 extern schar get_table_mapchr(lua_State *, const char *);
@@ -1669,6 +1679,7 @@ extern void nhl_add_table_entry_int(lua_State *, const char *, int);
 extern void nhl_add_table_entry_char(lua_State *, const char *, char);
 extern void nhl_add_table_entry_str(lua_State *, const char *, const char *);
 extern schar splev_chr2typ(char);
+extern char splev_typ2chr(schar);
 extern schar check_mapchr(const char *);
 extern int get_table_int(lua_State *, const char *);
 extern int get_table_int_opt(lua_State *, const char *, int);
@@ -2145,6 +2156,7 @@ extern int dorecover(NHFILE *);
 extern void restcemetery(NHFILE *, struct cemetery **);
 extern void trickery(char *);
 extern void getlev(NHFILE *, int, xchar);
+extern void snapshot_restore(struct snapshot *);
 extern void get_plname_from_file(NHFILE *, char *);
 #ifdef SELECTSAVED
 extern int restore_menu(winid);
@@ -2166,13 +2178,31 @@ extern void genl_outrip(winid, int, time_t);
 extern void init_isaac64(unsigned long, int(*fn)(int));
 extern long nhrand(void);
 #endif
+extern unsigned long rng_draws(int(*fn)(int));
+extern size_t rng_state_size(void);
+extern void get_rngstate(int(*fn)(int), genericptr_t);
+extern void set_rngstate(int(*fn)(int), genericptr_t);
 extern int rn2(int);
 extern int rn2_on_display_rng(int);
+extern void save_rngstate(NHFILE *);
+extern void rest_rngstate(NHFILE *);
 extern int rnl(int);
 extern int rnd(int);
 extern int d(int, int);
 extern int rne(int);
 extern int rnz(int);
+#ifdef RNGTRACE
+extern void rng_caller(const char *, int);
+extern void dump_rngtrace(FILE *);
+#define rn2(x) (rng_caller(__FILE__, __LINE__), rn2(x))
+#define rn2_on_display_rng(x) \
+    (rng_caller(__FILE__, __LINE__), rn2_on_display_rng(x))
+#define rnl(x) (rng_caller(__FILE__, __LINE__), rnl(x))
+#define rnd(x) (rng_caller(__FILE__, __LINE__), rnd(x))
+#define d(n, x) (rng_caller(__FILE__, __LINE__), d(n, x))
+#define rne(x) (rng_caller(__FILE__, __LINE__), rne(x))
+#define rnz(x) (rng_caller(__FILE__, __LINE__), rnz(x))
+#endif
 
 /* ### role.c ### */
 
@@ -2234,8 +2264,13 @@ extern boolean close_check(int);
 extern void savecemetery(NHFILE *, struct cemetery **);
 extern void savefruitchn(NHFILE *);
 extern void store_plname_in_file(NHFILE *);
+extern void discard_gamestate(void);
 extern void free_dungeons(void);
 extern void freedynamicdata(void);
+extern void snaplevel_forget(int);
+extern void snaplevel_put(xchar, struct snaplevel *);
+extern struct snapshot *snapshot_take(void);
+extern void snapshot_free(struct snapshot *);
 extern void store_savefileinfo(NHFILE *);
 extern void store_savefileinfo(NHFILE *);
 extern int nhdatatypes_size(void);
@@ -2275,6 +2310,14 @@ extern void Minit(const char *, int);
 #if defined(ZEROCOMP)
 extern void zerocomp_bclose(int);
 #endif
+extern int memfile_create(void);
+extern int memfile_open(const char *, size_t);
+extern int memfile_map(int);
+extern boolean memfile_rewind(int);
+extern int nhread(int, genericptr_t, unsigned);
+extern char *memfile_close(int, size_t *);
+extern void lzon(int, boolean);
+extern void lzoff(int);
 
 /* ### shk.c ### */
 
@@ -2407,6 +2450,7 @@ extern boolean load_special(const char *);
 extern xchar selection_getpoint(int, int, struct selectionvar *);
 extern struct selectionvar *selection_new(void);
 extern void selection_free(struct selectionvar *, boolean);
+extern void selection_copy(struct selectionvar *, struct selectionvar *);
 extern struct selectionvar *selection_clone(struct selectionvar *);
 extern void set_selection_floodfillchk(int(*)(int,int));
 extern void selection_floodfill(struct selectionvar *, int, int, boolean);
@@ -2414,6 +2458,15 @@ extern boolean pm_good_location(int, int, struct permonst *);
 extern void get_location_coord(xchar *, xchar *, int, struct mkroom *, long);
 extern void selection_setpoint(int, int, struct selectionvar *, xchar);
 extern struct selectionvar * selection_not(struct selectionvar *);
+extern void selection_and(struct selectionvar *, struct selectionvar *,
+                          struct selectionvar *);
+extern void selection_or(struct selectionvar *, struct selectionvar *,
+                         struct selectionvar *);
+extern void selection_xor(struct selectionvar *, struct selectionvar *,
+                          struct selectionvar *);
+extern int selection_numpoints(struct selectionvar *);
+extern boolean selection_nthpoint(struct selectionvar *, int, xchar *,
+                                  xchar *);
 extern void selection_filter_percent(struct selectionvar *, int);
 extern int selection_rndcoord(struct selectionvar *, xchar *, xchar *,
                               boolean);
@@ -2564,6 +2617,7 @@ extern void save_timers(NHFILE *, int);
 extern void restore_timers(NHFILE *, int, long);
 extern void timer_stats(const char *, char *, long *, long *);
 extern void relink_timers(boolean);
+extern void rehash_timer(struct fe *);
 extern int wiz_timeout_queue(void);
 extern void timer_sanity_check(void);
 
@@ -2862,6 +2916,7 @@ extern void vision_recalc(int);
 extern void block_point(int, int);
 extern void unblock_point(int, int);
 extern boolean clear_path(int, int, int, int);
+extern boolean mon_clear_path(struct monst *, int, int);
 extern void do_clear_area(int, int, int, void(*)(int, int, void *),
                           genericptr_t);
 extern unsigned howmonseen(struct monst *);
@@ -3024,6 +3079,8 @@ void commit_windowchain(void);
 #endif
 extern boolean genl_can_suspend_no(void);
 extern boolean genl_can_suspend_yes(void);
+extern void genl_print_glyph_run(winid, xchar, xchar, int,
+                                 const glyph_info *, const glyph_info *);
 extern char genl_message_menu(char, int, const char *);
 extern void genl_preference_update(const char *);
 extern char *genl_getmsghistory(boolean);
@@ -134,6 +134,7 @@ struct flag {
     boolean showrace;  /* show hero glyph by race rather than by role */
     boolean travelcmd; /* allow travel command */
     int runmode;       /* update screen display during run moves */
+    int rng_profile;   /* how random numbers are made; see rnd.c */
 };
 
 /*
@@ -181,6 +182,8 @@ struct instance_flags {
     boolean sad_feeling;   /* unseen pet is dying */
     int at_midnight;       /* only valid during end of game disclosure */
     int at_night;          /* also only valid during end of game disclosure */
+    time_t fixed_now;      /* if nonzero, getnow() returns this instead of
+                            * the current time (for levgen's replays) */
     int failing_untrap;    /* move_into_trap() -> spoteffects() -> dotrap() */
     int in_lava_effects;   /* hack for Boots_off() */
     int last_msg;          /* indicator of last message player saw */
@@ -423,6 +426,12 @@ enum runmode_types {
     RUN_CRAWL      /* walk w/ extra delay after each update */
 };
 
+/* rng_profile options */
+enum rng_profile_types {
+    RNG_CLASSIC = 0, /* 64 bits modulo the bound, as always */
+    RNG_FAST         /* multiply and shift, not compatible with classic */
+};
+
 /* paranoid confirmation prompting */
 /* any yes confirmations also require explicit no (or ESC) to reject */
 #define ParanoidConfirm ((flags.paranoia_bits & PARANOID_CONFIRM) != 0)
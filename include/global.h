@@ -13,6 +13,7 @@
  */
 
 #define RECORD "record"         /* file containing list of topscorers */
+#define RECORDINDEX "record.idx" /* index to RECORD for looking up scores */
 #define HELP "help"             /* file containing command descriptions */
 #define SHELP "hh"              /* abbreviated form of the same */
 #define KEYHELP "keyhelp"       /* explanatory text for 'whatdoes' command */
@@ -330,6 +331,30 @@ extern char *nhdupstr(const char *, const char *, int);
 extern long *alloc(unsigned int);  /* alloc.c */
 #endif /* ?MONITOR_HEAP */
 
+/*
+ * Pools of fixed-size chunks for things which come and go in large
+ * numbers (objects, monsters and their extra data).  Chunks are carved
+ * from big slabs and go back onto the pool's free list when released,
+ * so making or restoring a level mostly reuses memory that an earlier
+ * one gave back instead of calling malloc() for each thing.  Only
+ * 'name' and 'esize' need to be initialized.  See alloc.c.
+ */
+struct nhpool {
+    const char *name;      /* for wizard mode #stats */
+    unsigned esize;        /* size of the things kept in the pool */
+    unsigned csize;        /* esize rounded up for alignment */
+    unsigned perslab;      /* chunks per slab */
+    genericptr_t freelist; /* available chunks */
+    genericptr_t slabs;    /* all the slabs */
+    long nslabs;           /* # of slabs */
+    long inuse;            /* # of chunks handed out and not yet returned */
+    long peak;             /* highest 'inuse' so far */
+};
+
+extern genericptr_t nhpool_get(struct nhpool *);
+extern void nhpool_put(struct nhpool *, genericptr_t);
+extern boolean nhpool_release(struct nhpool *);
+
 /* Used for consistency checks of various data files; declare it here so
    that utility programs which include config.h but not hack.h can see it. */
 struct version_info {
@@ -349,10 +374,12 @@ struct savefile_info {
 #define SFI1_EXTERNALCOMP (1UL)
 #define SFI1_RLECOMP (1UL << 1)
 #define SFI1_ZEROCOMP (1UL << 2)
+#define SFI1_LZCOMP (1UL << 3)
 #else
 #define SFI1_EXTERNALCOMP (1L)
 #define SFI1_RLECOMP (1L << 1)
 #define SFI1_ZEROCOMP (1L << 2)
+#define SFI1_LZCOMP (1L << 3)
 #endif
 
 /*
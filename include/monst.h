@@ -190,7 +190,7 @@ struct monst {
     struct mextra *mextra; /* point to mextra struct */
 };
 
-#define newmonst() (struct monst *) alloc(sizeof (struct monst))
+#define newmonst() (struct monst *) pool_get(POOL_MONST)
 
 /* these are in mspeed */
 #define MSLOW 1 /* slowed monster */
@@ -128,12 +128,25 @@ struct obj {
     long age;               /* creation date */
     long owornmask;
     unsigned lua_ref_cnt;  /* # of lua script references for this object */
+    unsigned long o_floorseq; /* when it last went onto the floor; fobj is
+                               * kept in nonincreasing o_floorseq order */
     xchar omigr_from_dnum; /* where obj is migrating from */
     xchar omigr_from_dlevel; /* where obj is migrating from */
     struct oextra *oextra; /* pointer to oextra struct */
 };
 
-#define newobj() (struct obj *) alloc(sizeof(struct obj))
+#define newobj() (struct obj *) pool_get(POOL_OBJ)
+
+/* object class masks for searches of the floor object index (rm.h) */
+#define OCLASS_BIT(c) (1UL << (c))
+#define ALL_OCLASS_BITS (OCLASS_BIT(MAXOCLASSES) - 1UL)
+
+/* iterator state for first_obj_in_area() and next_obj_in_area() */
+struct obj_area {
+    struct obj **hits; /* the matching objects, in fobj order */
+    int nhits;         /* how many */
+    int next;          /* index of the next one to return */
+};
 
 /***
  **     oextra referencing and testing macros
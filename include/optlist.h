@@ -390,6 +390,8 @@ opt_##a,
 #endif
     NHOPTB(rest_on_space, 0, opt_in, set_in_game, Off, Yes, No, No, NoAlias,
                 &flags.rest_on_space)
+    NHOPTC(rng_profile, sizeof "classic", opt_in, set_gameview, No, Yes, No,
+                No, NoAlias, "how random numbers are generated")
     NHOPTC(roguesymset, 70, opt_in, set_in_game, No, Yes, No, Yes, NoAlias,
                 "load a set of rogue display symbols from symbols file")
     NHOPTC(role, PL_CSIZ, opt_in, set_gameview, No, Yes, No, No, "character",
@@ -6,6 +6,8 @@
 #ifndef RM_H
 #define RM_H
 
+#include "objclass.h" /* MAXOCLASSES, for the floor object index */
+
 /*
  * The dungeon presentation graphics code and data structures were rewritten
  * and generalized for NetHack's release 2 by Eric S. Raymond (eric@snark)
@@ -580,9 +582,27 @@ struct levelflags {
                                   rather than ROOM */
 };
 
+/*
+ * Coarse spatial index of the floor objects on a level.  The map is cut
+ * into buckets of OBJ_BUCKET_COLS x OBJ_BUCKET_ROWS spots; each bucket
+ * counts the objects of each class lying in it.  place_object() and
+ * remove_object() keep it current so that searches of part of the map
+ * can skip buckets holding nothing of interest instead of walking fobj.
+ */
+#define OBJ_BUCKET_COLS 8
+#define OBJ_BUCKET_ROWS 7
+#define OBJ_BUCKETS_X ((COLNO + OBJ_BUCKET_COLS - 1) / OBJ_BUCKET_COLS)
+#define OBJ_BUCKETS_Y ((ROWNO + OBJ_BUCKET_ROWS - 1) / OBJ_BUCKET_ROWS)
+
+struct obj_bucket {
+    unsigned long classes;  /* OCLASS_BIT() of every class present */
+    int count[MAXOCLASSES]; /* number of objects of each class */
+};
+
 typedef struct {
     struct rm locations[COLNO][ROWNO];
     struct obj *objects[COLNO][ROWNO];
+    struct obj_bucket objbuckets[OBJ_BUCKETS_X][OBJ_BUCKETS_Y];
     struct monst *monsters[COLNO][ROWNO];
     struct obj *objlist;
     struct obj *buriedobjlist;
@@ -28,6 +28,7 @@ struct sysopt {
     int check_save_uid; /* restoring savefile checks UID? */
     int check_plname; /* use plname for checking wizards/explorers/shellers */
     int bones_pools;
+    int levelstore; /* kilobytes of levels kept in memory, 0 for none */
 
     /* record file */
     int persmax;
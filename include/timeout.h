@@ -40,13 +40,20 @@ enum timeout_types {
 
 /* used in timeout.c */
 typedef struct fe {
-    struct fe *next;          /* next item in chain */
+    struct fe *next;          /* next item in chain of all timers */
     long timeout;             /* when we time out */
     unsigned long tid;        /* timer ID */
     short kind;               /* kind of use */
     short func_index;         /* what to call when we time out */
     anything arg;             /* pointer to timeout argument */
     Bitfield(needs_fixup, 1); /* does arg need to be patched? */
+    /* the rest is only meaningful in memory; it links the timer into
+       the indices timeout.c uses to find it (rehash_timer() must be
+       called if arg is changed outside of timeout.c) */
+    struct fe **prevp;           /* what points to us in the all-chain */
+    struct fe *rnext, **rprevp;  /* chain of timers sharing a timeout */
+    struct fe *anext, **aprevp;  /* chain of timers hashed by arg */
+    struct timer_run *run;       /* timers going off at our timeout */
 } timer_element;
 
 #endif /* TIMEOUT_H */
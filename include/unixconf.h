@@ -231,6 +231,13 @@
 #define USE_FCNTL
 #endif
 
+/* mmap(2) lets a save file being restored be read straight out of memory
+ * instead of with a read(2) for every field.  Comment out USE_MMAP if
+ * your system lacks it; restoring falls back to reading if it fails. */
+#ifdef POSIX_TYPES
+#define USE_MMAP
+#endif
+
 /*
  * The remainder of the file should not need to be changed.
  */
@@ -48,6 +48,8 @@ struct window_procs {
 #endif
     void (*win_print_glyph)(winid, xchar, xchar,
                             const glyph_info *, const glyph_info *);
+    void (*win_print_glyph_run)(winid, xchar, xchar, int,
+                                const glyph_info *, const glyph_info *);
     void (*win_raw_print)(const char *);
     void (*win_raw_print_bold)(const char *);
     int (*win_nhgetch)(void);
@@ -126,6 +128,7 @@ extern
 #define update_positionbar (*windowprocs.win_update_positionbar)
 #endif
 #define print_glyph (*windowprocs.win_print_glyph)
+#define print_glyph_run (*windowprocs.win_print_glyph_run)
 #define raw_print (*windowprocs.win_raw_print)
 #define raw_print_bold (*windowprocs.win_raw_print_bold)
 #define nhgetch (*windowprocs.win_nhgetch)
@@ -352,6 +355,9 @@ struct chain_procs {
     void (*win_print_glyph)(CARGS, winid, xchar, xchar,
                             const glyph_info *,
                             const glyph_info *);
+    void (*win_print_glyph_run)(CARGS, winid, xchar, xchar, int,
+                                const glyph_info *,
+                                const glyph_info *);
     void (*win_raw_print)(CARGS, const char *);
     void (*win_raw_print_bold)(CARGS, const char *);
     int (*win_nhgetch)(CARGS);
@@ -429,6 +435,8 @@ extern void safe_update_positionbar(char *);
 #endif
 extern void safe_print_glyph(winid, xchar, xchar,
                              const glyph_info *, const glyph_info *);
+extern void safe_print_glyph_run(winid, xchar, xchar, int,
+                                 const glyph_info *, const glyph_info *);
 extern void safe_raw_print(const char *);
 extern void safe_raw_print_bold(const char *);
 extern int safe_nhgetch(void);
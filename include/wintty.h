@@ -213,6 +213,8 @@ E void tty_update_positionbar(char *);
 #endif
 E void tty_print_glyph(winid, xchar, xchar, const glyph_info *,
                        const glyph_info *);
+E void tty_print_glyph_run(winid, xchar, xchar, int, const glyph_info *,
+                           const glyph_info *);
 E void tty_raw_print(const char *);
 E void tty_raw_print_bold(const char *);
 E int tty_nhgetch(void);
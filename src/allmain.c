@@ -604,8 +604,11 @@ display_gamewindows(void)
     display_nhwindow(WIN_MAP, FALSE);
 }
 
+/* everything newgame() does before creating the first level: pick the
+   character, lay out the dungeon and hand out the starting inventory;
+   also used by util/levgen.c to set up a game without playing it */
 void
-newgame(void)
+newgame_setup(void)
 {
     int i;
 
@@ -632,6 +635,12 @@ newgame(void)
     init_artifacts(); /* before u_init() in case $WIZKIT specifies
                        * any artifacts */
     u_init();
+}
+
+void
+newgame(void)
+{
+    newgame_setup();
 
 #ifndef NO_SIGNAL
     (void) signal(SIGINT, (SIG_RET_TYPE) done1);
@@ -150,4 +150,102 @@ dupstr(const char *string)
     return strcpy((char *) alloc(strlen(string) + 1), string);
 }
 
+/*
+ * Fixed-size chunk pools.
+ *
+ * Each slab is one alloc() holding a link to the next slab followed by
+ * 'perslab' chunks.  A free chunk's first bytes link it to the next one
+ * on the free list; a chunk in use belongs entirely to its owner.
+ * Chunks are never given back to malloc() one at a time, only all of a
+ * pool's slabs at once by nhpool_release().
+ *
+ * With MONITOR_HEAP, every chunk is a separate allocation logged under
+ * the pool's name, so that heaputil can still match each one up.
+ */
+
+/* strictest alignment anything kept in a pool might need */
+union nhpool_align {
+    genericptr_t p;
+    long l;
+    double d;
+};
+
+#define NHPOOL_SLABSIZE (16 * 1024) /* aim for slabs about this big */
+#define NHPOOL_MINPERSLAB 8
+
+genericptr_t
+nhpool_get(struct nhpool *pool)
+{
+    genericptr_t chunk;
+
+    if (!pool->csize) {
+        unsigned align = (unsigned) sizeof (union nhpool_align);
+
+        pool->csize = (pool->esize + align - 1) / align * align;
+        if (pool->csize < align)
+            pool->csize = align;
+        pool->perslab = (NHPOOL_SLABSIZE - align) / pool->csize;
+        if (pool->perslab < NHPOOL_MINPERSLAB)
+            pool->perslab = NHPOOL_MINPERSLAB;
+    }
+#ifdef MONITOR_HEAP
+    chunk = (genericptr_t) nhalloc(pool->csize, pool->name, 0);
+#else
+    if (!pool->freelist) {
+        char *slab, *p;
+        unsigned i, align = (unsigned) sizeof (union nhpool_align);
+
+        slab = (char *) alloc(align + pool->perslab * pool->csize);
+        *(genericptr_t *) slab = pool->slabs;
+        pool->slabs = (genericptr_t) slab;
+        pool->nslabs++;
+        /* link the new chunks so that they're handed out in address order */
+        for (i = pool->perslab, p = slab + align + i * pool->csize; i > 0;
+             --i) {
+            p -= pool->csize;
+            *(genericptr_t *) p = pool->freelist;
+            pool->freelist = (genericptr_t) p;
+        }
+    }
+    chunk = pool->freelist;
+    pool->freelist = *(genericptr_t *) chunk;
+#endif
+    if (++pool->inuse > pool->peak)
+        pool->peak = pool->inuse;
+    return chunk;
+}
+
+void
+nhpool_put(struct nhpool *pool, genericptr_t chunk)
+{
+    if (!chunk)
+        return;
+#ifdef MONITOR_HEAP
+    nhfree(chunk, pool->name, 0);
+#else
+    *(genericptr_t *) chunk = pool->freelist;
+    pool->freelist = chunk;
+#endif
+    pool->inuse--;
+}
+
+/* give all of a pool's slabs back to malloc(); refuses if any chunk is
+   still in use, since freeing it out from under its owner would be worse
+   than leaking it */
+boolean
+nhpool_release(struct nhpool *pool)
+{
+    genericptr_t slab;
+
+    if (pool->inuse)
+        return FALSE;
+    while ((slab = pool->slabs) != 0) {
+        pool->slabs = *(genericptr_t *) slab;
+        free(slab);
+    }
+    pool->freelist = (genericptr_t) 0;
+    pool->nslabs = 0L;
+    return TRUE;
+}
+
 /*alloc.c*/
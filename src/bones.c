@@ -520,6 +520,8 @@ savebones(int how, time_t when, struct obj *corpse)
     nhfp->mode = WRITING | FREEING;
     store_version(nhfp);
     store_savefileinfo(nhfp);
+    if (nhfp->structlevel && (sfsaveinfo.sfi1 & SFI1_LZCOMP))
+        lzon(nhfp->fd, FALSE); /* the rest is compressed */
     if (nhfp->structlevel) {
         /* if a bones pool digit is in use, it precedes the bonesid
            string and isn't recorded in the file */
@@ -576,6 +578,8 @@ getbones(void)
                 return 0;
             }
         }
+        if (nhfp->structlevel && (sfrestinfo.sfi1 & SFI1_LZCOMP))
+            lzon(nhfp->fd, TRUE);
         if (nhfp->structlevel) {
             /* if a bones pool digit is in use, it precedes the bonesid
                string and wasn't recorded in the file */
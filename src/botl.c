@@ -1349,18 +1349,16 @@ status_finish(void)
         }
 #endif /* STATUS_HILITES */
     }
+    g.blinit = FALSE; /* a new game can set them up again */
 }
 
+/* status_initialize() makes sure that this is only called once for
+   each status_finish() */
 static void
 init_blstats(void)
 {
-    static boolean initalready = FALSE;
     int i, j;
 
-    if (initalready) {
-        impossible("init_blstats called more than once.");
-        return;
-    }
     for (i = 0; i <= 1; ++i) {
         for (j = 0; j < MAXBLSTATS; ++j) {
 #ifdef STATUS_HILITES
@@ -1379,7 +1377,6 @@ init_blstats(void)
 #endif
         }
     }
-    initalready = TRUE;
 }
 
 /*
@@ -149,6 +149,7 @@ static void mon_chain(winid, const char *, struct monst *, boolean, long *,
                       long *);
 static void contained_stats(winid, const char *, long *, long *);
 static void misc_stats(winid, long *, long *);
+static void pool_stats(winid, long *, long *);
 static boolean accept_menu_prefix(int (*)(void));
 
 static void add_herecmd_menuitem(winid, int (*)(void), const char *);
@@ -2827,6 +2828,32 @@ misc_stats(winid win, long *total_count, long *total_size)
     }
 }
 
+/* chunk pools; count is chunks in use, size is the memory set aside */
+static void
+pool_stats(winid win, long *total_count, long *total_size)
+{
+    char buf[BUFSZ], hdrbuf[QBUFSZ];
+    long size;
+    int idx;
+    struct nhpool *pool;
+
+    for (idx = 0; idx < NUM_NHPOOLS; ++idx) {
+        pool = &nhpools[idx];
+        if (!pool->nslabs && !pool->inuse)
+            continue;
+        if (pool->nslabs)
+            size = pool->nslabs * (long) pool->perslab * (long) pool->csize;
+        else /* MONITOR_HEAP; each chunk is allocated separately */
+            size = pool->inuse * (long) pool->csize;
+        *total_count += pool->inuse;
+        *total_size += size;
+        Sprintf(hdrbuf, "%s, size %u, peak %ld", pool->name, pool->csize,
+                pool->peak);
+        Sprintf(buf, template, hdrbuf, pool->inuse, size);
+        putstr(win, 0, buf);
+    }
+}
+
 /*
  * Display memory usage of all monsters and objects on the level.
  */
@@ -2838,7 +2865,8 @@ wiz_show_stats(void)
     long total_obj_size, total_obj_count,
          total_mon_size, total_mon_count,
          total_ovr_size, total_ovr_count,
-         total_misc_size, total_misc_count;
+         total_misc_size, total_misc_count,
+         total_pool_size, total_pool_count;
 
     win = create_nhwindow(NHW_TEXT);
     putstr(win, 0, "Current memory statistics:");
@@ -2905,6 +2933,16 @@ wiz_show_stats(void)
              + total_ovr_size + total_misc_size));
     putstr(win, 0, buf);
 
+    /* objects and monsters above live in these, so they aren't part of
+       the grand total */
+    total_pool_count = total_pool_size = 0L;
+    putstr(win, 0, "");
+    putstr(win, 0, "  Pools, chunks in use");
+    pool_stats(win, &total_pool_count, &total_pool_size);
+    putstr(win, 0, stats_sep);
+    Sprintf(buf, template, "  Pool total", total_pool_count, total_pool_size);
+    putstr(win, 0, buf);
+
 #if defined(__BORLANDC__) && !defined(_WIN32)
     show_borlandc_stats(win);
 #endif
@@ -36,6 +36,22 @@ NEARDATA struct obj *uwep, *uarm, *uswapwep,
 
 struct engr *head_engr;
 
+#define NHPOOL(nam, typ)                                                \
+    { nam, (unsigned) sizeof (typ), 0U, 0U, (genericptr_t) 0,           \
+      (genericptr_t) 0, 0L, 0L, 0L }
+struct nhpool nhpools[NUM_NHPOOLS] = {
+    NHPOOL("obj", struct obj),
+    NHPOOL("oextra", struct oextra),
+    NHPOOL("monst", struct monst),
+    NHPOOL("mextra", struct mextra),
+    NHPOOL("egd", struct egd),
+    NHPOOL("epri", struct epri),
+    NHPOOL("eshk", struct eshk),
+    NHPOOL("emin", struct emin),
+    NHPOOL("edog", struct edog),
+};
+#undef NHPOOL
+
 #ifdef TEXTCOLOR
 /*
  *  This must be the same order as used for buzz() in zap.c.
@@ -130,7 +146,7 @@ const struct savefile_info default_sfinfo = {
 #else
     0x00000000L
 #endif
-#if defined(COMPRESS) || defined(ZLIB_COMP)
+#if (defined(COMPRESS) && !defined(LZCOMP)) || defined(ZLIB_COMP)
         | SFI1_EXTERNALCOMP
 #endif
 #if defined(ZEROCOMP)
@@ -138,6 +154,9 @@ const struct savefile_info default_sfinfo = {
 #endif
 #if defined(RLECOMP)
         | SFI1_RLECOMP
+#endif
+#if defined(LZCOMP)
+        | SFI1_LZCOMP
 #endif
     ,
 #ifdef NHSTDC
@@ -431,6 +450,11 @@ const struct instance_globals g_init = {
 #endif
     BONESINIT, /* bones */
     LOCKNAMEINIT, /* lock */
+    UNDEFINED_VALUES, /* lstore */
+    0, /* lstore_bytes */
+    0UL, /* lstore_clock */
+    -1, /* lstore_fd */
+    0, /* lstore_lev */
 
 
     /* hack.c */
@@ -453,6 +477,7 @@ const struct instance_globals g_init = {
     UNDEFINED_VALUES,
 
     /* makemon.c */
+    UNDEFINED_VALUES, /* rndmonst_cache */
 
     /* mhitm.c */
     0L, /* noisetime */
@@ -491,6 +516,9 @@ const struct instance_globals g_init = {
 
     /* mkobj.c */
     FALSE, /* mkcorpstat_norevive */
+    0UL, /* floorseq */
+    NULL, /* area_hits */
+    0, /* area_hits_size */
 
     /* mon.c */
     FALSE, /* vamp_rise_msg */
@@ -517,6 +545,11 @@ const struct instance_globals g_init = {
     MAX_LAN_USERNAME, /* lusername_size */
 #endif /* MAX_LAN_USERNAME */
 
+    /* nhlua.c */
+    UNDEFINED_PTR, /* luacore */
+    UNDEFINED_PTR, /* luacore_nhlib */
+    0, /* luacore_nhlib_len */
+
     /* o_init.c */
     DUMMY, /* disco */
 
@@ -617,6 +650,7 @@ const struct instance_globals g_init = {
     0, /* usteed_id */
     (struct obj *) 0, /* looseball */
     (struct obj *) 0, /* loosechain */
+    UNDEFINED_VALUES, /* snaplevels */
 
     /* shk.c */
     'a', /* sell_response */
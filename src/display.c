@@ -1743,7 +1743,8 @@ flush_screen(int cursor_on_u)
     static int flushing = 0;
     static int delay_flushing = 0;
     register int x, y;
-    glyph_info bkglyphinfo = nul_glyphinfo;
+    int x0 = 0, n;
+    glyph_info ginfo[COLNO], bkginfo[COLNO];
 
     /* 3.7: don't update map, status, or perm_invent during save/restore */
     if (g.program_state.saving || g.program_state.restoring)
@@ -1761,27 +1762,36 @@ flush_screen(int cursor_on_u)
         return;
 #endif
 
+    /* pass each run of changed locations to the window port at once */
     for (y = 0; y < ROWNO; y++) {
         register gbuf_entry *gptr = &g.gbuf[y][x = g.gbuf_start[y]];
 
-        for (; x <= g.gbuf_stop[y]; gptr++, x++)
+        for (n = 0; x <= g.gbuf_stop[y]; gptr++, x++)
             if (gptr->gnew) {
-                bkglyphinfo.glyph = get_bk_glyph(x, y);            
-                print_glyph(WIN_MAP, x, y,
-                            Glyphinfo_at(x, y, gptr->glyph), &bkglyphinfo);
+                if (!n)
+                    x0 = x;
+                bkginfo[n] = nul_glyphinfo;
+                bkginfo[n].glyph = get_bk_glyph(x, y);
+                ginfo[n++] = *Glyphinfo_at(x, y, gptr->glyph);
                 gptr->gnew = 0;
+            } else if (n) {
+                print_glyph_run(WIN_MAP, x0, y, n, ginfo, bkginfo);
+                n = 0;
             }
+        if (n)
+            print_glyph_run(WIN_MAP, x0, y, n, ginfo, bkginfo);
     }
 
-    if (cursor_on_u)
-        curs(WIN_MAP, u.ux, u.uy); /* move cursor to the hero */
-    display_nhwindow(WIN_MAP, FALSE);
     reset_glyph_bbox();
     flushing = 0;
+    /* update status before showing the map so that both go out together */
     if (g.context.botl || g.context.botlx)
         bot();
     else if (iflags.time_botl)
         timebot();
+    if (cursor_on_u)
+        curs(WIN_MAP, u.ux, u.uy); /* move cursor to the hero */
+    display_nhwindow(WIN_MAP, FALSE);
 }
 
 /* ======================================================================== */
@@ -8,6 +8,11 @@
 #ifdef __DJGPP__
 #include <string.h>
 #endif
+#if defined(DLB) && defined(DLB_MMAP)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
 
 #define DATAPREFIX 4		/* see decl.h */
 
@@ -58,6 +63,11 @@ extern FILE *fopen_datafile(const char *, const char *, int);
 static library dlb_libs[MAX_LIBS];
 
 static boolean readlibdir(library * lp);
+static unsigned long hash_filename(const char *name);
+static void hash_libdir(library *lp);
+#ifdef DLB_MMAP
+static void map_library(library *lp);
+#endif
 static boolean find_file(const char *name, library **lib, long *startp,
                          long *sizep);
 static boolean lib_dlb_init(void);
@@ -163,6 +173,76 @@ readlibdir(library *lp) /* library pointer to fill in */
     return TRUE;
 }
 
+/* hash a file name; case is ignored since FILENAME_CMP might ignore it */
+static unsigned long
+hash_filename(const char *name)
+{
+    unsigned long h = 5381UL;
+    char c;
+
+    while ((c = *name++) != '\0') {
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        h = (h * 33UL) ^ (unsigned long) (unsigned char) c;
+    }
+    return h;
+}
+
+/*
+ * Build an open-addressed hash table over the library's directory so
+ * that find_file() doesn't have to compare against every entry.  The
+ * table is at least twice the size of the directory.
+ */
+static void
+hash_libdir(library *lp)
+{
+    int i, slot, mask;
+
+    for (lp->hashsize = 16; lp->hashsize < 2 * lp->nentries;)
+        lp->hashsize *= 2;
+    lp->hashtab = (int *) alloc(lp->hashsize * sizeof (int));
+    mask = lp->hashsize - 1;
+    for (i = 0; i < lp->hashsize; i++)
+        lp->hashtab[i] = -1;
+    for (i = 0; i < lp->nentries; i++) {
+        slot = (int) (hash_filename(lp->dir[i].fname) & mask);
+        while (lp->hashtab[slot] >= 0)
+            slot = (slot + 1) & mask;
+        lp->hashtab[slot] = i;
+    }
+}
+
+#ifdef DLB_MMAP
+/*
+ * Map the whole library file read-only and shared, so that reads are
+ * plain memory copies and every process running the game shares the
+ * same pages.  On any failure the library is simply read through stdio.
+ */
+static void
+map_library(library *lp)
+{
+    struct stat st;
+    genericptr_t p;
+    int i;
+
+    lp->fmap = (char *) 0;
+    lp->fmapsize = 0L;
+    if (fstat(fileno(lp->fdata), &st) < 0 || st.st_size <= 0)
+        return;
+    /* don't trust a directory that points past the end of the file */
+    for (i = 0; i < lp->nentries; i++)
+        if (lp->dir[i].foffset < 0 || lp->dir[i].fsize < 0
+            || lp->dir[i].foffset + lp->dir[i].fsize > (long) st.st_size)
+            return;
+    p = mmap((genericptr_t) 0, (size_t) st.st_size, PROT_READ, MAP_SHARED,
+             fileno(lp->fdata), (off_t) 0);
+    if (p == MAP_FAILED)
+        return;
+    lp->fmap = (char *) p;
+    lp->fmapsize = (long) st.st_size;
+}
+#endif /* DLB_MMAP */
+
 /*
  * Look for the file in our directory structure.  Return 1 if successful,
  * 0 if not found.  Fill in the size and starting position.
@@ -170,12 +250,15 @@ readlibdir(library *lp) /* library pointer to fill in */
 static boolean
 find_file(const char *name, library **lib, long *startp, long *sizep)
 {
-    int i, j;
+    int i, j, slot, mask;
+    unsigned long h = hash_filename(name);
     library *lp;
 
     for (i = 0; i < MAX_LIBS && dlb_libs[i].fdata; i++) {
         lp = &dlb_libs[i];
-        for (j = 0; j < lp->nentries; j++) {
+        mask = lp->hashsize - 1;
+        for (slot = (int) (h & mask); (j = lp->hashtab[slot]) >= 0;
+             slot = (slot + 1) & mask) {
             if (FILENAME_CMP(name, lp->dir[j].fname) == 0) {
                 *lib = lp;
                 *startp = lp->dir[j].foffset;
@@ -201,6 +284,10 @@ open_library(const char *lib_name, library *lp)
     lp->fdata = fopen_datafile(lib_name, RDBMODE, DATAPREFIX);
     if (lp->fdata) {
         if (readlibdir(lp)) {
+            hash_libdir(lp);
+#ifdef DLB_MMAP
+            map_library(lp);
+#endif
             status = TRUE;
         } else {
             (void) fclose(lp->fdata);
@@ -213,9 +300,15 @@ open_library(const char *lib_name, library *lp)
 void
 close_library(library *lp)
 {
+#ifdef DLB_MMAP
+    if (lp->fmap)
+        (void) munmap((genericptr_t) lp->fmap, (size_t) lp->fmapsize);
+#endif
     (void) fclose(lp->fdata);
     free((genericptr_t) lp->dir);
     free((genericptr_t) lp->sspace);
+    if (lp->hashtab)
+        free((genericptr_t) lp->hashtab);
 
     (void) memset((char *) lp, 0, sizeof(library));
 }
@@ -303,6 +396,15 @@ lib_dlb_fread(char *buf, int size, int quan, dlb *dp)
         return 0;
 
     pos = dp->start + dp->mark;
+#ifdef DLB_MMAP
+    if (dp->lib->fmap) {
+        nbytes = (long) quan * size;
+        (void) memcpy((genericptr_t) buf, (genericptr_t) (dp->lib->fmap + pos),
+                      (size_t) nbytes);
+        dp->mark += nbytes;
+        return quan;
+    }
+#endif
     if (dp->lib->fmark != pos) {
         fseek(dp->lib->fdata, pos, SEEK_SET); /* check for error??? */
         dp->lib->fmark = pos;
@@ -355,6 +457,25 @@ lib_dlb_fgets(char *buf, int len, dlb *dp)
         return (char *) 0;
 
     len--; /* save room for null */
+#ifdef DLB_MMAP
+    if (dp->lib->fmap) {
+        /* copy up to and including the next newline straight out of
+           the mapping; lib_dlb_fseek() already just moved dp->mark, so
+           this is all that changes for callers such as rumors.c which
+           seek and then read a line */
+        const char *src = dp->lib->fmap + dp->start + dp->mark, *nl;
+        long n = dp->size - dp->mark;
+
+        if (n > len)
+            n = len;
+        if ((nl = (const char *) memchr((genericptr_t) src, '\n',
+                                        (size_t) n)) != 0)
+            n = (long) (nl - src) + 1;
+        (void) memcpy((genericptr_t) buf, (genericptr_t) src, (size_t) n);
+        dp->mark += n;
+        bp = buf + n;
+    } else
+#endif
     for (i = 0, bp = buf; i < len && dp->mark < dp->size && c != '\n';
          i++, bp++) {
         if (dlb_fread(bp, 1, 1, dp) <= 0)
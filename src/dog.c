@@ -13,7 +13,7 @@ newedog(struct monst *mtmp)
     if (!mtmp->mextra)
         mtmp->mextra = newmextra();
     if (!EDOG(mtmp)) {
-        EDOG(mtmp) = (struct edog *) alloc(sizeof(struct edog));
+        EDOG(mtmp) = (struct edog *) pool_get(POOL_EDOG);
         (void) memset((genericptr_t) EDOG(mtmp), 0, sizeof(struct edog));
     }
 }
@@ -22,7 +22,7 @@ void
 free_edog(struct monst *mtmp)
 {
     if (mtmp->mextra && EDOG(mtmp)) {
-        free((genericptr_t) EDOG(mtmp));
+        pool_put(POOL_EDOG, EDOG(mtmp));
         EDOG(mtmp) = (struct edog *) 0;
     }
     mtmp->mtame = 0;
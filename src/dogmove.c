@@ -494,6 +494,7 @@ dog_goal(register struct monst *mtmp, struct edog *edog,
 #define SQSRCHRADIUS 5
         int min_x, max_x, min_y, max_y;
         register int nx, ny;
+        struct obj_area oa;
 
         g.gtyp = UNDEF; /* no goal as yet */
         g.gx = g.gy = 0;  /* suppress 'used before set' message */
@@ -508,38 +509,38 @@ dog_goal(register struct monst *mtmp, struct edog *edog,
             max_y = ROWNO - 1;
 
         /* nearby food is the first choice, then other objects */
-        for (obj = fobj; obj; obj = obj->nobj) {
+        for (obj = first_obj_in_area(&oa, min_x, min_y, max_x, max_y,
+                                     ALL_OCLASS_BITS);
+             obj; obj = next_obj_in_area(&oa)) {
             nx = obj->ox;
             ny = obj->oy;
-            if (nx >= min_x && nx <= max_x && ny >= min_y && ny <= max_y) {
-                otyp = dogfood(mtmp, obj);
-                /* skip inferior goals */
-                if (otyp > g.gtyp || otyp == UNDEF)
-                    continue;
-                /* avoid cursed items unless starving */
-                if (cursed_object_at(nx, ny)
-                    && !(edog->mhpmax_penalty && otyp < MANFOOD))
-                    continue;
-                /* skip completely unreachable goals */
-                if (!could_reach_item(mtmp, nx, ny)
-                    || !can_reach_location(mtmp, mtmp->mx, mtmp->my, nx, ny))
-                    continue;
-                if (otyp < MANFOOD) {
-                    if (otyp < g.gtyp || DDIST(nx, ny) < DDIST(g.gx, g.gy)) {
-                        g.gx = nx;
-                        g.gy = ny;
-                        g.gtyp = otyp;
-                    }
-                } else if (g.gtyp == UNDEF && in_masters_sight
-                           && !dog_has_minvent
-                           && (!levl[omx][omy].lit || levl[u.ux][u.uy].lit)
-                           && (otyp == MANFOOD || m_cansee(mtmp, nx, ny))
-                           && edog->apport > rn2(8)
-                           && can_carry(mtmp, obj) > 0) {
+            otyp = dogfood(mtmp, obj);
+            /* skip inferior goals */
+            if (otyp > g.gtyp || otyp == UNDEF)
+                continue;
+            /* avoid cursed items unless starving */
+            if (cursed_object_at(nx, ny)
+                && !(edog->mhpmax_penalty && otyp < MANFOOD))
+                continue;
+            /* skip completely unreachable goals */
+            if (!could_reach_item(mtmp, nx, ny)
+                || !can_reach_location(mtmp, mtmp->mx, mtmp->my, nx, ny))
+                continue;
+            if (otyp < MANFOOD) {
+                if (otyp < g.gtyp || DDIST(nx, ny) < DDIST(g.gx, g.gy)) {
                     g.gx = nx;
                     g.gy = ny;
-                    g.gtyp = APPORT;
+                    g.gtyp = otyp;
                 }
+            } else if (g.gtyp == UNDEF && in_masters_sight
+                       && !dog_has_minvent
+                       && (!levl[omx][omy].lit || levl[u.ux][u.uy].lit)
+                       && (otyp == MANFOOD || m_cansee(mtmp, nx, ny))
+                       && edog->apport > rn2(8)
+                       && can_carry(mtmp, obj) > 0) {
+                g.gx = nx;
+                g.gy = ny;
+                g.gtyp = APPORT;
             }
         }
     }
@@ -669,6 +669,9 @@ panic VA_DECL(const char *, str)
         raw_print(buf);
         paniclog("panic", buf);
     }
+#ifdef RNGTRACE
+    dump_rngtrace(stderr); /* the random numbers which led up to it */
+#endif
 #ifdef WIN32
     interject(INTERJECT_PANIC);
 #endif
@@ -122,6 +122,15 @@ extern char *sounddir; /* defined in sounds.c */
 
 static NHFILE *new_nhfile(void);
 static void free_nhfile(NHFILE *);
+static int levelfile_creat(int);
+static boolean lstore_write(int);
+#ifdef LZCOMP
+static void lstore_pack(struct levelstore *);
+static int lstore_unpack(struct levelstore *);
+#endif
+static void lstore_free(int);
+static void lstore_spill(void);
+static void lstore_commit(void);
 #ifdef SELECTSAVED
 static int QSORTCALLBACK strcmp_wrap(const void *, const void *);
 #endif
@@ -436,7 +445,9 @@ void
 close_nhfile(NHFILE *nhfp)
 {
     if (nhfp) {
-        if (nhfp->structlevel && nhfp->fd != -1)
+        if (nhfp->structlevel && nhfp->fd != -1 && nhfp->fd == g.lstore_fd)
+            lstore_commit(), nhfp->fd = -1; /* level written to memory */
+        else if (nhfp->structlevel && nhfp->fd != -1)
             (void) nhclose(nhfp->fd), nhfp->fd = -1;
         zero_nhfile(nhfp);
         free_nhfile(nhfp);
@@ -446,7 +457,9 @@ close_nhfile(NHFILE *nhfp)
 void
 rewind_nhfile(NHFILE *nhfp)
 {
-    if (nhfp->structlevel) {
+    if (nhfp->structlevel)
+        lzoff(nhfp->fd); /* the header at the start isn't compressed */
+    if (nhfp->structlevel && !memfile_rewind(nhfp->fd)) {
 #ifdef BSD
         (void) lseek(nhfp->fd, 0L, 0);
 #else
@@ -498,16 +511,217 @@ set_levelfile_name(char *file, int lev)
     return;
 }
 
+/*
+ * The level store.  With SYSCF's LEVELSTORE set, the levels which would
+ * be written to level files while the hero is elsewhere are kept in
+ * memory instead, as the images savelev() would have written, and
+ * create_levelfile() and open_levelfile() hand out in-memory files for
+ * them (see sfstruct.c).  Once the images take up more than LEVELSTORE
+ * kilobytes, the least recently used ones are spilled to their level
+ * files.  An INSURANCE checkpoint writes out any that aren't on disk
+ * yet, so that recover still finds every level, but keeps them in memory
+ * too; returning to a level then reads it from memory rather than from
+ * its file.  Level 0, the lock file, always stays on disk.
+ *
+ * With LZCOMP, the images are kept compressed.  What goes to the level
+ * files is the plain image, since recover copies those into a save file
+ * as they are.
+ */
+
+/* create a level file on disk; returns a descriptor or -1 */
+static int
+levelfile_creat(int lev)
+{
+    const char *fq_lock;
+    int fd;
+
+    set_levelfile_name(g.lock, lev);
+    fq_lock = fqname(g.lock, LEVELPREFIX, 0);
+#if defined(MICRO) || defined(WIN32)
+    /* Use O_TRUNC to force the file to be shortened if it already
+     * exists and is currently longer.
+     */
+    fd = open(fq_lock, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, FCMASK);
+#else
+#ifdef MAC
+    fd = maccreat(fq_lock, LEVL_TYPE);
+#else
+    fd = creat(fq_lock, FCMASK);
+#endif
+#endif /* MICRO || WIN32 */
+    return fd;
+}
+
+/* write a stored level out to its level file; returns FALSE on failure */
+static boolean
+lstore_write(int lev)
+{
+    struct levelstore *ls = &g.lstore[lev];
+    int fd = levelfile_creat(lev);
+    boolean ok;
+    char *data = ls->data;
+    size_t len = ls->len;
+#ifdef LZCOMP
+    int mfd = -1;
+
+    if (ls->packed && fd >= 0) {
+        mfd = lstore_unpack(ls);
+        data = memfile_close(mfd, &len);
+    }
+#endif
+
+    if (fd < 0)
+        return FALSE;
+    ok = ((size_t) write(fd, (genericptr_t) data, len) == len);
+    (void) close(fd);
+#ifdef LZCOMP
+    if (mfd >= 0)
+        free((genericptr_t) data);
+#endif
+    ls->ondisk = ok;
+    return ok;
+}
+
+#ifdef LZCOMP
+/* compress a level's image in place; it stays as it is if that doesn't
+   make it any smaller */
+static void
+lstore_pack(struct levelstore *ls)
+{
+    int fd = memfile_create();
+    char *data;
+    size_t len;
+
+    lzon(fd, FALSE);
+    bwrite(fd, (genericptr_t) ls->data, (unsigned) ls->len);
+    lzoff(fd);
+    data = memfile_close(fd, &len);
+    if (len < ls->len) {
+        free((genericptr_t) ls->data);
+        ls->data = data, ls->rawlen = ls->len, ls->len = len;
+        ls->packed = TRUE;
+    } else {
+        free((genericptr_t) data);
+    }
+}
+
+/* a new in-memory file holding the plain image of a compressed level,
+   ready to be read from the start */
+static int
+lstore_unpack(struct levelstore *ls)
+{
+    int zfd = memfile_open(ls->data, ls->len), fd = memfile_create();
+    char buf[BUFSZ * 8];
+    size_t left;
+    unsigned cnt;
+
+    lzon(zfd, TRUE);
+    for (left = ls->rawlen; left > 0; left -= cnt) {
+        cnt = (unsigned) min(left, sizeof buf);
+        mread(zfd, (genericptr_t) buf, cnt);
+        bwrite(fd, (genericptr_t) buf, cnt);
+    }
+    lzoff(zfd);
+    (void) memfile_close(zfd, (size_t *) 0);
+    (void) memfile_rewind(fd);
+    return fd;
+}
+#endif /* LZCOMP */
+
+/* drop a level's image from memory */
+static void
+lstore_free(int lev)
+{
+    struct levelstore *ls = &g.lstore[lev];
+
+    if (ls->data) {
+        g.lstore_bytes -= ls->len;
+        free((genericptr_t) ls->data);
+        ls->data = (char *) 0;
+        ls->len = ls->rawlen = 0;
+        ls->packed = FALSE;
+    }
+}
+
+/* move least recently used levels out to disk until within budget */
+static void
+lstore_spill(void)
+{
+    size_t budget = (size_t) sysopt.levelstore * 1024L;
+    int lev, oldest;
+
+    while (g.lstore_bytes > budget) {
+        for (oldest = -1, lev = 1; lev < MAXLINFO; lev++)
+            if (g.lstore[lev].data
+                && (oldest < 0
+                    || g.lstore[lev].lastuse < g.lstore[oldest].lastuse))
+                oldest = lev;
+        if (oldest < 0)
+            break;
+        if (!g.lstore[oldest].ondisk && !lstore_write(oldest)) {
+            /* nowhere to put it; go over budget rather than lose it */
+            impossible("Cannot spill level %d to disk (errno %d).", oldest,
+                       errno);
+            return;
+        }
+        lstore_free(oldest);
+    }
+}
+
+/* a level has been written to the in-memory file g.lstore_fd */
+static void
+lstore_commit(void)
+{
+    int lev = g.lstore_lev;
+    struct levelstore *ls = &g.lstore[lev];
+
+    lstore_free(lev);
+    ls->data = memfile_close(g.lstore_fd, &ls->len);
+#ifdef LZCOMP
+    lstore_pack(ls);
+#endif
+    ls->lastuse = ++g.lstore_clock;
+    g.lstore_bytes += ls->len;
+    g.lstore_fd = -1;
+    lstore_spill();
+}
+
+/* make sure every stored level is in its level file as well; for the
+   INSURANCE checkpoint, which is how levels left while checkpointing
+   reach the disk */
+void
+lstore_flush(void)
+{
+    int lev;
+
+    for (lev = 1; lev < MAXLINFO; lev++)
+        if (g.lstore[lev].data && !g.lstore[lev].ondisk
+            && !lstore_write(lev))
+            impossible("Cannot write level %d to disk (errno %d).", lev,
+                       errno);
+}
+
 NHFILE *
 create_levelfile(int lev, char errbuf[])
 {
-    const char *fq_lock;
     NHFILE *nhfp = (NHFILE *) 0;
+    boolean instore = (sysopt.levelstore > 0 && lev > 0);
 
     if (errbuf)
         *errbuf = '\0';
-    set_levelfile_name(g.lock, lev);
-    fq_lock = fqname(g.lock, LEVELPREFIX, 0);
+    snaplevel_forget(lev); /* snapshots' copy of the old contents */
+    if (instore) {
+        if (g.lstore_fd >= 0)
+            panic("create_levelfile: level %d is still being written",
+                  g.lstore_lev);
+        /* whatever is in memory or on disk is about to be out of date */
+        lstore_free(lev);
+        if (g.lstore[lev].ondisk) {
+            set_levelfile_name(g.lock, lev);
+            (void) unlink(fqname(g.lock, LEVELPREFIX, 0));
+            g.lstore[lev].ondisk = FALSE;
+        }
+    }
 
     nhfp = new_nhfile();
     if (nhfp) {
@@ -520,18 +734,13 @@ create_levelfile(int lev, char errbuf[])
         nhfp->style.binary = TRUE;
         nhfp->fd = -1;
         nhfp->fpdef = (FILE *) 0;
-#if defined(MICRO) || defined(WIN32)
-        /* Use O_TRUNC to force the file to be shortened if it already
-         * exists and is currently longer.
-         */
-        nhfp->fd = open(fq_lock, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, FCMASK);
-#else
-#ifdef MAC
-        nhfp->fd = maccreat(fq_lock, LEVL_TYPE);
-#else
-        nhfp->fd = creat(fq_lock, FCMASK);
-#endif
-#endif /* MICRO || WIN32 */
+        if (instore) {
+            nhfp->fd = g.lstore_fd = memfile_create();
+            g.lstore_lev = lev;
+        } else {
+            nhfp->fd = levelfile_creat(lev);
+            g.lstore[lev].ondisk = (nhfp->fd >= 0);
+        }
 
         if (nhfp->fd >= 0)
             g.level_info[lev].flags |= LFILE_EXISTS;
@@ -548,6 +757,7 @@ open_levelfile(int lev, char errbuf[])
 {
     const char *fq_lock;
     NHFILE *nhfp = (NHFILE *) 0;
+    struct levelstore *ls = &g.lstore[lev];
 
     if (errbuf)
         *errbuf = '\0';
@@ -565,7 +775,17 @@ open_levelfile(int lev, char errbuf[])
         nhfp->fd = -1;
         nhfp->fpdef = (FILE *) 0;
     }
-    if (nhfp && nhfp->structlevel) {
+    if (nhfp && nhfp->structlevel && lev > 0 && ls->data) {
+        /* the image stays in the store; it's freed by the next
+           create_levelfile() or delete_levelfile() for this level */
+#ifdef LZCOMP
+        if (ls->packed)
+            nhfp->fd = lstore_unpack(ls);
+        else
+#endif
+            nhfp->fd = memfile_open(ls->data, ls->len);
+        ls->lastuse = ++g.lstore_clock;
+    } else if (nhfp && nhfp->structlevel) {
 #ifdef MAC
         nhfp->fd = macopen(fq_lock, O_RDONLY | O_BINARY, LEVL_TYPE);
 #else
@@ -591,10 +811,16 @@ delete_levelfile(int lev)
      * call create_levfile(), so always assume that it exists.
      */
     if (lev == 0 || (g.level_info[lev].flags & LFILE_EXISTS)) {
-        set_levelfile_name(g.lock, lev);
-        (void) unlink(fqname(g.lock, LEVELPREFIX, 0));
+        if (lev > 0)
+            lstore_free(lev);
+        if (lev == 0 || g.lstore[lev].ondisk || !sysopt.levelstore) {
+            set_levelfile_name(g.lock, lev);
+            (void) unlink(fqname(g.lock, LEVELPREFIX, 0));
+        }
+        g.lstore[lev].ondisk = FALSE;
         g.level_info[lev].flags &= ~LFILE_EXISTS;
     }
+    snaplevel_forget(lev);
 }
 
 void
@@ -636,6 +862,7 @@ nhclose(int fd)
     int retval = 0;
 
     if (fd >= 0) {
+        lzoff(fd);
         if (close_check(fd))
             bclose(fd);
         else
@@ -1069,6 +1296,9 @@ open_savefile(void)
 #else
             nhfp->fd = open(fq_save, O_RDONLY | O_BINARY, 0);
 #endif
+            /* read it from memory rather than a field at a time */
+            if (nhfp->fd >= 0)
+                nhfp->fd = memfile_map(nhfp->fd);
         }
     }
     nhfp = viable_nhfile(nhfp);
@@ -1506,12 +1736,19 @@ docompress_file(const char *filename, boolean uncomp)
 #else
 #define UNUSED_if_not_COMPRESS UNUSED
 #endif
+/* with LZCOMP, save and bones files are already compressed as they're
+   written; COMPRESS is only used to uncompress ones left by older builds */
+#if (defined(COMPRESS) && !defined(LZCOMP)) || defined(ZLIB_COMP)
+#define UNUSED_if_not_COMPRESS_ON_SAVE /*empty*/
+#else
+#define UNUSED_if_not_COMPRESS_ON_SAVE UNUSED
+#endif
 
 /* compress file */
 void
-nh_compress(const char *filename UNUSED_if_not_COMPRESS)
+nh_compress(const char *filename UNUSED_if_not_COMPRESS_ON_SAVE)
 {
-#if !defined(COMPRESS) && !defined(ZLIB_COMP)
+#if (!defined(COMPRESS) || defined(LZCOMP)) && !defined(ZLIB_COMP)
 #ifdef PRAGMA_UNUSED
 #pragma unused(filename)
 #endif
@@ -1698,10 +1935,59 @@ static int lockfd = -1; /* for lock_file() to pass to unlock_file() */
 #endif
 #ifdef USE_FCNTL
 struct flock sflock; /* for unlocking, same as above */
+
+static volatile int lock_timedout;
+static void lock_alarm(int);
+static boolean fcntl_lock_wait(int, int);
 #endif
 
 #define HUP if (!g.program_state.done_hup)
 
+#ifdef USE_FCNTL
+/* SIGALRM handler; only has to interrupt fcntl_lock_wait()'s F_SETLKW */
+static void
+lock_alarm(int sig UNUSED)
+{
+    lock_timedout = 1;
+}
+
+/* wait up to 'secs' seconds for the fcntl lock on fd; F_SETLKW returns
+   as soon as the holder lets go, and an alarm cuts it short if that
+   doesn't happen in time */
+static boolean
+fcntl_lock_wait(int fd, int secs)
+{
+    boolean locked;
+    unsigned oldalarm;
+#ifdef SA_RESTART
+    struct sigaction sact, oldsact;
+
+    /* without SA_RESTART, so that the alarm interrupts fcntl() */
+    (void) memset((genericptr_t) &sact, 0, sizeof sact);
+    sact.sa_handler = lock_alarm;
+    (void) sigaction(SIGALRM, &sact, &oldsact);
+#else
+    void (*oldhandler)(int) = signal(SIGALRM, lock_alarm);
+#endif
+
+    lock_timedout = 0;
+    oldalarm = alarm((unsigned) secs);
+    /* other signals, such as a hangup, just resume the wait */
+    while (!(locked = (fcntl(fd, F_SETLKW, &sflock) != -1))
+           && errno == EINTR && !lock_timedout)
+        continue;
+    (void) alarm(0);
+#ifdef SA_RESTART
+    (void) sigaction(SIGALRM, &oldsact, (struct sigaction *) 0);
+#else
+    (void) signal(SIGALRM, oldhandler);
+#endif
+    if (oldalarm)
+        (void) alarm(oldalarm); /* close enough; nethack doesn't use any */
+    return locked;
+}
+#endif /* USE_FCNTL */
+
 #ifndef USE_FCNTL
 static char *
 make_lockname(const char *filename, char *lockname)
@@ -1788,18 +2074,21 @@ lock_file(const char *filename, int whichprefix, int retryct)
 #endif
 
 #ifdef USE_FCNTL
-        if (retryct--) {
+        /* rather than polling once a second, block until the lock is
+           released, for as many seconds as there would have been tries */
+        if (retryct > 0) {
             HUP raw_printf(
-               "Waiting for release of fcntl lock on %s.  (%d retries left.)",
+                  "Waiting for release of fcntl lock on %s.  (%d seconds.)",
                            filename, retryct);
-            sleep(1);
-        } else {
-            HUP(void) raw_print("I give up.  Sorry.");
-            HUP raw_printf("Some other process has an unnatural grip on %s.",
-                           filename);
-            g.nesting--;
-            return FALSE;
+            if (fcntl_lock_wait(lockfd, retryct))
+                break;
         }
+        HUP(void) raw_print("I give up.  Sorry.");
+        HUP raw_printf("Some other process has an unnatural grip on %s.",
+                       filename);
+        (void) close(lockfd), lockfd = -1;
+        g.nesting--;
+        return FALSE;
 #else
         int errnosv = errno;
 
@@ -2507,6 +2796,9 @@ parse_config_line(char *origbuf)
         if (sysopt.recover)
             free((genericptr_t) sysopt.recover);
         sysopt.recover = dupstr(bufp);
+    } else if (in_sysconf && match_varname(buf, "LEVELSTORE", 10)) {
+        n = atoi(bufp);
+        sysopt.levelstore = (n <= 0) ? 0 : n;
     } else if (in_sysconf && match_varname(buf, "CHECK_SAVE_UID", 14)) {
         n = atoi(bufp);
         sysopt.check_save_uid = n;
@@ -947,6 +947,313 @@ test_move(int ux, int uy, int dx, int dy, int mode)
     return TRUE;
 }
 
+/*
+ * Breadth-first search used by travel.  It spreads out from a root spot
+ * one ring (radius) at a time; dir[][] records, for each spot reached,
+ * the direction from the neighbor through which it was first reached.
+ * The order in which spots are examined doesn't depend on where the
+ * hero is, so a search rooted at the travel destination can be kept and
+ * resumed as the hero moves toward it, until the map changes.
+ */
+struct travel_bfs {
+    xchar travel[COLNO][ROWNO]; /* radius at which a spot was queued */
+    schar dir[COLNO][ROWNO];    /* xdir[]/ydir[] index of the first step
+                                 * into a spot, or -1 if not reached yet */
+    xchar stepx[2][COLNO * ROWNO];
+    xchar stepy[2][COLNO * ROWNO];
+    int n;      /* number of spots queued for the next ring */
+    int set;    /* which of stepx/stepy[] holds the next ring */
+    int radius; /* search radius */
+    xchar rootx, rooty;
+};
+
+/* what a cached search depends on besides the map itself */
+struct travel_key {
+    d_level uz;
+    xchar rootx, rooty;
+    xchar trapx, trapy; /* hero's spot if it has a trap or known pool */
+    int umonnum;
+    int squeeze;        /* cant_squeeze_thru() */
+    unsigned props;     /* TKEY_xxx */
+};
+
+#define TKEY_PASSWALL  0x0001
+#define TKEY_OOZE      0x0002
+#define TKEY_UNDERWATR 0x0004
+#define TKEY_LEVITATE  0x0008
+#define TKEY_FLY       0x0010
+#define TKEY_BLIND     0x0020
+#define TKEY_SOKOBAN   0x0040
+#define TKEY_RUN8      0x0080
+#define TKEY_DIGGER    0x0100
+
+/* per-spot summary of everything test_move() looks at while traveling */
+#define TSNAP_TYPMASK  0x003f
+#define TSNAP_FLGSHIFT 6
+#define TSNAP_KNOWN    0x0800 /* seenv, or in view while not blind */
+#define TSNAP_BOULDER  0x1000
+#define TSNAP_TRAP     0x2000 /* trap the hero knows about */
+#define TSNAP_SEEN     0x4000 /* seenv; test_move() checks it by itself */
+
+/* a search kept between calls, with what it was started from */
+struct travel_cache {
+    struct travel_bfs bfs;
+    struct travel_key key;
+    boolean valid;
+    unsigned short snap[COLNO][ROWNO]; /* TSNAP_xxx for each spot */
+};
+
+/* travel steps search from the destination; getpos()'s TRAVP_VALID
+   probes search from the hero, so each kind keeps its own */
+static struct travel_cache travel_cache, travel_probe_cache;
+
+static void travel_bfs_init(struct travel_bfs *, int, int);
+static void travel_bfs_round(struct travel_bfs *, int, int, int);
+static void travel_get_key(struct travel_key *, int, int);
+static boolean travel_snapshot_same(struct travel_cache *);
+static struct travel_bfs *travel_search(struct travel_cache *, int, int);
+static int travel_dir_to(struct travel_bfs *, int, int);
+
+static void
+travel_bfs_init(struct travel_bfs *tb, int rootx, int rooty)
+{
+    (void) memset((genericptr_t) tb->travel, 0, sizeof tb->travel);
+    (void) memset((genericptr_t) tb->dir, -1, sizeof tb->dir);
+    tb->rootx = rootx;
+    tb->rooty = rooty;
+    tb->stepx[0][0] = rootx;
+    tb->stepy[0][0] = rooty;
+    tb->set = 0;
+    tb->n = tb->radius = 1;
+}
+
+/* examine the next ring of spots; for TRAVP_GUESS, only spots the hero
+   could see are included and <goalx,goaly> is never queued */
+static void
+travel_bfs_round(struct travel_bfs *tb, int mode, int goalx, int goaly)
+{
+    static int ordered[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+    /* no diagonal movement for grid bugs */
+    int dirmax = NODIAG(u.umonnum) ? 4 : 8;
+    int set = tb->set, radius = tb->radius;
+    int i, nn = 0;
+
+    for (i = 0; i < tb->n; i++) {
+        int dir;
+        int x = tb->stepx[set][i];
+        int y = tb->stepy[set][i];
+        boolean alreadyrepeated = FALSE;
+
+        for (dir = 0; dir < dirmax; ++dir) {
+            int nx = x + xdir[ordered[dir]];
+            int ny = y + ydir[ordered[dir]];
+
+            /*
+             * When guessing and trying to travel as close as possible
+             * to an unreachable target space, don't include spaces
+             * that would never be picked as a guessed target in the
+             * travel matrix describing hero-reachable spaces.
+             * This stops travel from getting confused and moving
+             * the hero back and forth in certain degenerate
+             * configurations of sight-blocking obstacles, e.g.
+             *
+             *  T         1. Dig this out and carry enough to not be
+             *   ####       able to squeeze through diagonal gaps.
+             *   #--.---    Stand at @ and target travel at space T.
+             *    @.....
+             *    |.....
+             *
+             *  T         2. couldsee() marks spaces marked a and x
+             *   ####       as eligible guess spaces to move the hero
+             *   a--.---    towards.  Space a is closest to T, so it
+             *    @xxxxx    gets chosen.  Travel system moves @ right
+             *    |xxxxx    to travel to space a.
+             *
+             *  T         3. couldsee() marks spaces marked b, c and x
+             *   ####       as eligible guess spaces to move the hero
+             *   a--c---    towards.  Since findtravelpath() is called
+             *    b@xxxx    repeatedly during travel, it doesn't
+             *    |xxxxx    remember that it wanted to go to space a,
+             *              so in comparing spaces b and c, b is
+             *              chosen, since it seems like the closest
+             *              eligible space to T. Travel system moves @
+             *              left to go to space b.
+             *
+             *            4. Go to 2.
+             *
+             * By limiting the travel matrix here, space a in the
+             * example above is never included in it, preventing
+             * the cycle.
+             */
+            if (!isok(nx, ny)
+                || ((mode == TRAVP_GUESS) && !couldsee(nx, ny)))
+                continue;
+            if ((!Passes_walls && !can_ooze(&g.youmonst)
+                 && closed_door(x, y)) || sobj_at(BOULDER, x, y)
+                || test_move(x, y, nx - x, ny - y, TEST_TRAP)) {
+                /* closed doors and boulders usually
+                 * cause a delay, so prefer another path */
+                if (tb->travel[x][y] > radius - 3) {
+                    if (!alreadyrepeated) {
+                        tb->stepx[1 - set][nn] = x;
+                        tb->stepy[1 - set][nn] = y;
+                        /* don't change travel matrix! */
+                        nn++;
+                        alreadyrepeated = TRUE;
+                    }
+                    continue;
+                }
+            }
+            if (test_move(x, y, nx - x, ny - y, TEST_TRAV)
+                && (levl[nx][ny].seenv || (!Blind && couldsee(nx, ny)))) {
+                if (tb->dir[nx][ny] < 0)
+                    tb->dir[nx][ny] = ordered[dir];
+                if (nx == goalx && ny == goaly) {
+                    ; /* not part of the guess matrix */
+                } else if (!tb->travel[nx][ny]) {
+                    tb->stepx[1 - set][nn] = nx;
+                    tb->stepy[1 - set][nn] = ny;
+                    tb->travel[nx][ny] = radius;
+                    nn++;
+                }
+            }
+        }
+    }
+
+#ifdef DEBUG
+    if (iflags.trav_debug) {
+        /* Use of warning glyph is arbitrary. It stands out. */
+        tmp_at(DISP_ALL, warning_to_glyph(1));
+        for (i = 0; i < nn; ++i) {
+            tmp_at(tb->stepx[1 - set][i], tb->stepy[1 - set][i]);
+        }
+        delay_output();
+        if (flags.runmode == RUN_CRAWL) {
+            delay_output();
+            delay_output();
+        }
+        tmp_at(DISP_END, 0);
+    }
+#endif /* DEBUG */
+
+    tb->n = nn;
+    tb->set = 1 - set;
+    tb->radius++;
+}
+
+/* collect the non-map state that a travel search rooted at <rootx,rooty>
+   depends on */
+static void
+travel_get_key(struct travel_key *key, int rootx, int rooty)
+{
+    struct trap *t = t_at(u.ux, u.uy);
+    struct obj *obj;
+
+    (void) memset((genericptr_t) key, 0, sizeof *key);
+    key->uz = u.uz;
+    key->rootx = rootx, key->rooty = rooty;
+    /* test_move() doesn't treat the hero's own spot as a hazard */
+    if ((t && t->tseen) || is_pool_or_lava(u.ux, u.uy))
+        key->trapx = u.ux, key->trapy = u.uy;
+    key->umonnum = u.umonnum;
+    key->squeeze = cant_squeeze_thru(&g.youmonst);
+    if (Passes_walls)
+        key->props |= TKEY_PASSWALL;
+    if (can_ooze(&g.youmonst))
+        key->props |= TKEY_OOZE;
+    if (Underwater)
+        key->props |= TKEY_UNDERWATR;
+    if (Levitation)
+        key->props |= TKEY_LEVITATE;
+    if (Flying)
+        key->props |= TKEY_FLY;
+    if (Blind)
+        key->props |= TKEY_BLIND;
+    if (Sokoban)
+        key->props |= TKEY_SOKOBAN;
+    if (g.context.run == 8)
+        key->props |= TKEY_RUN8;
+    if (carrying(PICK_AXE) || carrying(DWARVISH_MATTOCK)
+        || ((obj = carrying(WAN_DIGGING))
+            && !objects[obj->otyp].oc_name_known))
+        key->props |= TKEY_DIGGER;
+}
+
+/* summarize the map as test_move() sees it and report whether that
+   matches the summary taken when tc's search was started */
+static boolean
+travel_snapshot_same(struct travel_cache *tc)
+{
+    unsigned short snap[COLNO][ROWNO];
+    struct trap *t;
+    struct rm *lev;
+    int x, y;
+    boolean same;
+
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++) {
+            lev = &levl[x][y];
+            snap[x][y] = (unsigned short) ((lev->typ & TSNAP_TYPMASK)
+                                           | (lev->flags << TSNAP_FLGSHIFT));
+            if (lev->seenv)
+                snap[x][y] |= TSNAP_SEEN | TSNAP_KNOWN;
+            else if (!Blind && couldsee(x, y))
+                snap[x][y] |= TSNAP_KNOWN;
+            if ((g.level.objbuckets[x / OBJ_BUCKET_COLS][y / OBJ_BUCKET_ROWS]
+                     .classes & OCLASS_BIT(ROCK_CLASS))
+                && sobj_at(BOULDER, x, y))
+                snap[x][y] |= TSNAP_BOULDER;
+        }
+    for (t = g.ftrap; t; t = t->ntrap)
+        if (t->tseen)
+            snap[t->tx][t->ty] |= TSNAP_TRAP;
+
+    same = !memcmp((genericptr_t) snap, (genericptr_t) tc->snap,
+                   sizeof snap);
+    if (!same)
+        (void) memcpy((genericptr_t) tc->snap, (genericptr_t) snap,
+                      sizeof snap);
+    return same;
+}
+
+/* return the search rooted at <rootx,rooty>, reusing the one in tc if
+   nothing it depends on has changed since it was started */
+static struct travel_bfs *
+travel_search(struct travel_cache *tc, int rootx, int rooty)
+{
+    struct travel_key key;
+    struct monst *mtmp;
+    boolean reuse = tc->valid;
+
+    travel_get_key(&key, rootx, rooty);
+    if (memcmp((genericptr_t) &key, (genericptr_t) &tc->key, sizeof key))
+        reuse = FALSE;
+    /* always take the snapshot so that the next call has one to check */
+    if (!travel_snapshot_same(tc))
+        reuse = FALSE;
+    /* long worm tails move every turn and block diagonal squeezes */
+    for (mtmp = fmon; mtmp && reuse; mtmp = mtmp->nmon)
+        if (mtmp->wormno && !DEADMONSTER(mtmp))
+            reuse = FALSE;
+
+    if (!reuse) {
+        travel_bfs_init(&tc->bfs, rootx, rooty);
+        tc->key = key;
+        tc->valid = TRUE;
+    }
+    return &tc->bfs;
+}
+
+/* extend the search until <x,y> has been reached or can't be; returns
+   the xdir[]/ydir[] index of the step that reaches it, or -1 */
+static int
+travel_dir_to(struct travel_bfs *tb, int x, int y)
+{
+    while (tb->dir[x][y] < 0 && tb->n != 0)
+        travel_bfs_round(tb, TRAVP_TRAVEL, -1, -1);
+    return tb->dir[x][y];
+}
+
 /*
  * Find a path from the destination (u.tx,u.ty) back to (u.ux,u.uy).
  * A shortest path is returned.  If guess is TRUE, consider various
@@ -976,14 +1283,9 @@ findtravelpath(int mode)
             g.context.run = 8;
     }
     if (u.tx != u.ux || u.ty != u.uy) {
-        xchar travel[COLNO][ROWNO];
-        xchar travelstepx[2][COLNO * ROWNO];
-        xchar travelstepy[2][COLNO * ROWNO];
+        struct travel_bfs *tb;
         xchar tx, ty, ux, uy;
-        int n = 1;      /* max offset in travelsteps */
-        int set = 0;    /* two sets current and previous */
-        int radius = 1; /* search radius */
-        int i;
+        int dir;
 
         /* If guessing, first find an "obvious" goal location.  The obvious
          * goal is the position the player knows of, or might figure out
@@ -1001,140 +1303,23 @@ findtravelpath(int mode)
             uy = u.uy;
         }
 
- noguess:
-        (void) memset((genericptr_t) travel, 0, sizeof travel);
-        travelstepx[0][0] = tx;
-        travelstepy[0][0] = ty;
-
-        while (n != 0) {
-            int nn = 0;
-
-            for (i = 0; i < n; i++) {
-                int dir;
-                int x = travelstepx[set][i];
-                int y = travelstepy[set][i];
-                static int ordered[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
-                /* no diagonal movement for grid bugs */
-                int dirmax = NODIAG(u.umonnum) ? 4 : 8;
-                boolean alreadyrepeated = FALSE;
-
-                for (dir = 0; dir < dirmax; ++dir) {
-                    int nx = x + xdir[ordered[dir]];
-                    int ny = y + ydir[ordered[dir]];
-
-                    /*
-                     * When guessing and trying to travel as close as possible
-                     * to an unreachable target space, don't include spaces
-                     * that would never be picked as a guessed target in the
-                     * travel matrix describing hero-reachable spaces.
-                     * This stops travel from getting confused and moving
-                     * the hero back and forth in certain degenerate
-                     * configurations of sight-blocking obstacles, e.g.
-                     *
-                     *  T         1. Dig this out and carry enough to not be
-                     *   ####       able to squeeze through diagonal gaps.
-                     *   #--.---    Stand at @ and target travel at space T.
-                     *    @.....
-                     *    |.....
-                     *
-                     *  T         2. couldsee() marks spaces marked a and x
-                     *   ####       as eligible guess spaces to move the hero
-                     *   a--.---    towards.  Space a is closest to T, so it
-                     *    @xxxxx    gets chosen.  Travel system moves @ right
-                     *    |xxxxx    to travel to space a.
-                     *
-                     *  T         3. couldsee() marks spaces marked b, c and x
-                     *   ####       as eligible guess spaces to move the hero
-                     *   a--c---    towards.  Since findtravelpath() is called
-                     *    b@xxxx    repeatedly during travel, it doesn't
-                     *    |xxxxx    remember that it wanted to go to space a,
-                     *              so in comparing spaces b and c, b is
-                     *              chosen, since it seems like the closest
-                     *              eligible space to T. Travel system moves @
-                     *              left to go to space b.
-                     *
-                     *            4. Go to 2.
-                     *
-                     * By limiting the travel matrix here, space a in the
-                     * example above is never included in it, preventing
-                     * the cycle.
-                     */
-                    if (!isok(nx, ny)
-                        || ((mode == TRAVP_GUESS) && !couldsee(nx, ny)))
-                        continue;
-                    if ((!Passes_walls && !can_ooze(&g.youmonst)
-                         && closed_door(x, y)) || sobj_at(BOULDER, x, y)
-                        || test_move(x, y, nx - x, ny - y, TEST_TRAP)) {
-                        /* closed doors and boulders usually
-                         * cause a delay, so prefer another path */
-                        if (travel[x][y] > radius - 3) {
-                            if (!alreadyrepeated) {
-                                travelstepx[1 - set][nn] = x;
-                                travelstepy[1 - set][nn] = y;
-                                /* don't change travel matrix! */
-                                nn++;
-                                alreadyrepeated = TRUE;
-                            }
-                            continue;
-                        }
-                    }
-                    if (test_move(x, y, nx - x, ny - y, TEST_TRAV)
-                        && (levl[nx][ny].seenv
-                            || (!Blind && couldsee(nx, ny)))) {
-                        if (nx == ux && ny == uy) {
-                            if (mode == TRAVP_TRAVEL || mode == TRAVP_VALID) {
-                                u.dx = x - ux;
-                                u.dy = y - uy;
-                                if (mode == TRAVP_TRAVEL
-                                    && x == u.tx && y == u.ty) {
-                                    nomul(0);
-                                    /* reset run so domove run checks work */
-                                    g.context.run = 8;
-                                    iflags.travelcc.x = iflags.travelcc.y = 0;
-                                }
-                                return TRUE;
-                            }
-                        } else if (!travel[nx][ny]) {
-                            travelstepx[1 - set][nn] = nx;
-                            travelstepy[1 - set][nn] = ny;
-                            travel[nx][ny] = radius;
-                            nn++;
-                        }
-                    }
-                }
-            }
-
-#ifdef DEBUG
-            if (iflags.trav_debug) {
-                /* Use of warning glyph is arbitrary. It stands out. */
-                tmp_at(DISP_ALL, warning_to_glyph(1));
-                for (i = 0; i < nn; ++i) {
-                    tmp_at(travelstepx[1 - set][i], travelstepy[1 - set][i]);
-                }
-                delay_output();
-                if (flags.runmode == RUN_CRAWL) {
-                    delay_output();
-                    delay_output();
-                }
-                tmp_at(DISP_END, 0);
-            }
-#endif /* DEBUG */
-
-            n = nn;
-            set = 1 - set;
-            radius++;
-        }
-
-        /* if guessing, find best location in travel matrix and go there */
         if (mode == TRAVP_GUESS) {
+            struct travel_bfs guess;
             int px = tx, py = ty; /* pick location */
             int dist, nxtdist, d2, nd2;
 
+            /* this depends on what the hero can see from the current
+               spot, so it isn't cached */
+            travel_bfs_init(&guess, tx, ty);
+            while (guess.n != 0)
+                travel_bfs_round(&guess, TRAVP_GUESS, ux, uy);
+
+            /* find best location in travel matrix and go there */
             dist = distmin(ux, uy, tx, ty);
             d2 = dist2(ux, uy, tx, ty);
             for (tx = 1; tx < COLNO; ++tx)
                 for (ty = 0; ty < ROWNO; ++ty)
-                    if (travel[tx][ty]) {
+                    if (guess.travel[tx][ty]) {
                         nxtdist = distmin(ux, uy, tx, ty);
                         if (nxtdist == dist && couldsee(tx, ty)) {
                             nd2 = dist2(ux, uy, tx, ty);
@@ -1179,10 +1364,27 @@ findtravelpath(int mode)
             ty = py;
             ux = u.ux;
             uy = u.uy;
-            set = 0;
-            n = radius = 1;
             mode = TRAVP_TRAVEL;
-            goto noguess;
+        }
+
+        /* getpos() probes a different spot each time from the same
+           root, so one search from the hero answers all of them */
+        tb = travel_search((mode == TRAVP_VALID) ? &travel_probe_cache
+                                                 : &travel_cache,
+                           tx, ty);
+        if ((dir = travel_dir_to(tb, ux, uy)) >= 0) {
+            /* step back toward the neighbor through which the search
+               reached <ux,uy> */
+            u.dx = -xdir[dir];
+            u.dy = -ydir[dir];
+            if (mode == TRAVP_TRAVEL
+                && ux + u.dx == u.tx && uy + u.dy == u.ty) {
+                nomul(0);
+                /* reset run so domove run checks work */
+                g.context.run = 8;
+                iflags.travelcc.x = iflags.travelcc.y = 0;
+            }
+            return TRUE;
         }
         return FALSE;
     }
@@ -938,6 +938,8 @@ getnow(void)
 {
     time_t datetime = 0;
 
+    if (iflags.fixed_now)
+        return iflags.fixed_now;
     (void) time((TIME_type) &datetime);
     return datetime;
 }
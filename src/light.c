@@ -7,9 +7,6 @@
 /*
  * Mobile light sources.
  *
- * This implementation minimizes memory at the expense of extra
- * recalculations.
- *
  * Light sources are "things" that have a physical position and range.
  * They have a type, which gives us information about them.  Currently
  * they are only attached to objects and monsters.  Note well:  the
@@ -24,12 +21,13 @@
  * The major working function is do_light_sources(). It is called
  * when the vision system is recreating its "could see" array.  Here
  * we add a flag (TEMP_LIT) to the array for all locations that are lit
- * via a light source.  The bad part of this is that we have to
- * re-calculate the LOS of each light source every time the vision
- * system runs.  Even if the light sources and any topology (vision blocking
- * positions) have not changed.  The good part is that no extra memory
- * is used, plus we don't have to figure out how far the sources have moved,
- * or if the topology has changed.
+ * via a light source.  Working out which locations a source can reach
+ * takes a clear_path() for each point in its circle, so the result is
+ * kept as a bitmap, the source's "footprint", and reused until the
+ * source moves, its range changes, or a location within its range
+ * starts or stops blocking light (block_point() and unblock_point()
+ * tell us via light_block_changed()).  Footprints are merged a word at
+ * a time before being added to the could see array.
  *
  * The structure of the save/restore mechanism is amazingly similar to
  * the timer save/restore.  This is because they both have the same
@@ -41,7 +39,18 @@
 #define LSF_SHOW 0x1        /* display the light source */
 #define LSF_NEEDS_FIXUP 0x2 /* need oid fixup */
 
+/* bitmap of the locations lit by one light source; row 0 is ls->y - range */
+#define LIT_BITS 32 /* bits used in each unsigned long */
+#define LIT_WORDS ((COLNO + LIT_BITS - 1) / LIT_BITS)
+struct ls_footprint {
+    xchar x, y;  /* where the source was when this was worked out */
+    short range; /* how far it reached then; -1 when out of date */
+    unsigned long rows[2 * MAX_RADIUS + 1][LIT_WORDS];
+};
+
 static light_source *new_light_core(xchar, xchar, int, int, anything *);
+static void free_light_source(light_source *);
+static void light_footprint(light_source *);
 static void discard_flashes(void);
 static void write_ls(NHFILE *, light_source *);
 static int maybe_write_ls(NHFILE *, int, boolean);
@@ -81,6 +90,7 @@ new_light_core(xchar x, xchar y, int range, int type, anything *id)
     ls->type = type;
     ls->id = *id;
     ls->flags = 0;
+    ls->footprint = (struct ls_footprint *) 0;
     g.light_base = ls;
 
     g.vision_full_recalc = 1; /* make the source show up */
@@ -123,7 +133,7 @@ del_light_source(int type, anything *id)
             else
                 g.light_base = curr->next;
 
-            free((genericptr_t) curr);
+            free_light_source(curr);
             g.vision_full_recalc = 1;
             return;
         }
@@ -132,24 +142,74 @@ del_light_source(int type, anything *id)
                fmt_ptr((genericptr_t) id->a_obj));
 }
 
+static void
+free_light_source(light_source *ls)
+{
+    if (ls->footprint)
+        free((genericptr_t) ls->footprint);
+    free((genericptr_t) ls);
+}
+
+/*
+ * Work out which points in the light source's circle are visible from
+ * its center and record them in its footprint.
+ *
+ * Kevin's tests indicated that doing this brute-force method is faster
+ * for radius <= 3 (or so).
+ */
+static void
+light_footprint(light_source *ls)
+{
+    struct ls_footprint *fp = ls->footprint;
+    int x, y, min_x, max_x, max_y, offset;
+    xchar *limits;
+    unsigned long *bits;
+
+    if (!fp)
+        fp = ls->footprint = (struct ls_footprint *) alloc(sizeof *fp);
+    (void) memset((genericptr_t) fp->rows, 0, sizeof fp->rows);
+    fp->x = ls->x, fp->y = ls->y;
+    fp->range = ls->range;
+
+    limits = circle_ptr(ls->range);
+    if ((max_y = (ls->y + ls->range)) >= ROWNO)
+        max_y = ROWNO - 1;
+    if ((y = (ls->y - ls->range)) < 0)
+        y = 0;
+    for (; y <= max_y; y++) {
+        bits = fp->rows[y - ls->y + ls->range];
+        offset = limits[abs(y - ls->y)];
+        if ((min_x = (ls->x - offset)) < 1)
+            min_x = 1;
+        if ((max_x = (ls->x + offset)) >= COLNO)
+            max_x = COLNO - 1;
+        for (x = min_x; x <= max_x; x++)
+            if ((ls->x == x && ls->y == y)
+                || clear_path((int) ls->x, (int) ls->y, x, y))
+                bits[x / LIT_BITS] |= 1UL << (x % LIT_BITS);
+    }
+}
+
 /* Mark locations that are temporarily lit via mobile light sources. */
 void
 do_light_sources(xchar **cs_rows)
 {
-    int x, y, min_x, max_x, max_y, offset;
+    int x, y, min_x, max_x, max_y, offset, i, w;
     xchar *limits;
     short at_hero_range = 0;
     light_source *ls;
+    struct ls_footprint *fp;
     xchar *row;
+    unsigned long bits, lit[ROWNO][LIT_WORDS];
+    boolean any_lit = FALSE;
 
+    (void) memset((genericptr_t) lit, 0, sizeof lit);
     for (ls = g.light_base; ls; ls = ls->next) {
         ls->flags &= ~LSF_SHOW;
 
         /*
-         * Check for moved light sources.  It may be possible to
-         * save some effort if an object has not moved, but not in
-         * the current setup -- we need to recalculate for every
-         * vision recalc.
+         * Check for moved light sources.  The footprint check below
+         * notices if this has changed anything.
          */
         if (ls->type == LS_OBJECT) {
             if (ls->range == 0 /* camera flash; caller has set ls->{x,y} */
@@ -169,13 +229,20 @@ do_light_sources(xchar **cs_rows)
                 at_hero_range = ls->range;
         }
 
-        if (ls->flags & LSF_SHOW) {
+        if (!(ls->flags & LSF_SHOW))
+            continue;
+
+        if (ls->x == u.ux && ls->y == u.uy) {
             /*
-             * Walk the points in the circle and see if they are
-             * visible from the center.  If so, mark'em.
-             *
-             * Kevin's tests indicated that doing this brute-force
-             * method is faster for radius <= 3 (or so).
+             * If the light source is located at the hero, then
+             * we can use the COULD_SEE bits already calculated
+             * by the vision system.  More importantly than
+             * this optimization, is that it allows the vision
+             * system to correct problems with clear_path().
+             * The function clear_path() is a simple LOS
+             * path checker that doesn't go out of its way to
+             * make things look "correct".  The vision system
+             * does this.
              */
             limits = circle_ptr(ls->range);
             if ((max_y = (ls->y + ls->range)) >= ROWNO)
@@ -189,33 +256,67 @@ do_light_sources(xchar **cs_rows)
                     min_x = 1;
                 if ((max_x = (ls->x + offset)) >= COLNO)
                     max_x = COLNO - 1;
-
-                if (ls->x == u.ux && ls->y == u.uy) {
-                    /*
-                     * If the light source is located at the hero, then
-                     * we can use the COULD_SEE bits already calculated
-                     * by the vision system.  More importantly than
-                     * this optimization, is that it allows the vision
-                     * system to correct problems with clear_path().
-                     * The function clear_path() is a simple LOS
-                     * path checker that doesn't go out of its way to
-                     * make things look "correct".  The vision system
-                     * does this.
-                     */
-                    for (x = min_x; x <= max_x; x++)
-                        if (row[x] & COULD_SEE)
-                            row[x] |= TEMP_LIT;
-                } else {
-                    for (x = min_x; x <= max_x; x++)
-                        if ((ls->x == x && ls->y == y)
-                            || clear_path((int) ls->x, (int) ls->y, x, y))
-                            row[x] |= TEMP_LIT;
-                }
+                for (x = min_x; x <= max_x; x++)
+                    if (row[x] & COULD_SEE)
+                        row[x] |= TEMP_LIT;
             }
+            continue;
+        }
+
+        fp = ls->footprint;
+        if (!fp || fp->range != ls->range || fp->x != ls->x
+            || fp->y != ls->y)
+            light_footprint(ls);
+        fp = ls->footprint;
+        for (i = 0; i <= 2 * fp->range; i++) {
+            y = fp->y - fp->range + i;
+            if (y < 0 || y >= ROWNO)
+                continue;
+            for (w = 0; w < LIT_WORDS; w++)
+                lit[y][w] |= fp->rows[i][w];
+        }
+        any_lit = TRUE;
+    }
+
+    if (!any_lit)
+        return;
+    for (y = 0; y < ROWNO; y++) {
+        row = cs_rows[y];
+        for (w = 0; w < LIT_WORDS; w++) {
+            if (!(bits = lit[y][w]))
+                continue;
+            for (x = w * LIT_BITS; bits; x++, bits >>= 1)
+                if (bits & 1UL)
+                    row[x] |= TEMP_LIT;
         }
     }
 }
 
+/* <x,y> has started or stopped blocking light; forget the footprints of
+   light sources which could reach it */
+void
+light_block_changed(int x, int y)
+{
+    light_source *ls;
+    struct ls_footprint *fp;
+
+    for (ls = g.light_base; ls; ls = ls->next)
+        if ((fp = ls->footprint) != 0 && fp->range >= 0
+            && abs(x - fp->x) <= fp->range && abs(y - fp->y) <= fp->range)
+            fp->range = -1;
+}
+
+/* forget every light source's footprint, for a new or changed level */
+void
+reset_light_footprints(void)
+{
+    light_source *ls;
+
+    for (ls = g.light_base; ls; ls = ls->next)
+        if (ls->footprint)
+            ls->footprint->range = -1;
+}
+
 /* lit 'obj' has been thrown or kicked and is passing through x,y on the
    way to its destination; show its light so that hero has a chance to
    remember terrain, objects, and monsters being revealed;
@@ -405,7 +506,7 @@ save_light_sources(NHFILE *nhfp, int range)
             /* if global and not doing local, or vice versa, remove it */
             if (is_global ^ (range == RANGE_LEVEL)) {
                 *prev = curr->next;
-                free((genericptr_t) curr);
+                free_light_source(curr);
             } else {
                 prev = &(*prev)->next;
             }
@@ -431,6 +532,7 @@ restore_light_sources(NHFILE *nhfp)
         ls = (light_source *) alloc(sizeof(light_source));
         if (nhfp->structlevel)
             mread(nhfp->fd, (genericptr_t) ls, sizeof(light_source));
+        ls->footprint = (struct ls_footprint *) 0;
         ls->next = g.light_base;
         g.light_base = ls;
     }
@@ -449,6 +551,8 @@ light_stats(const char *hdrfmt, char *hdrbuf, long *count, long *size)
     for (ls = g.light_base; ls; ls = ls->next) {
         ++*count;
         *size += (long) sizeof *ls;
+        if (ls->footprint)
+            *size += (long) sizeof *ls->footprint;
     }
 }
 
@@ -684,6 +788,7 @@ obj_split_light_source(struct obj *src, struct obj *dest)
              */
             new_ls = (light_source *) alloc(sizeof(light_source));
             *new_ls = *ls;
+            new_ls->footprint = (struct ls_footprint *) 0;
             if (Is_candle(src)) {
                 /* split candles may emit less light than original group */
                 ls->range = candle_light_range(src);
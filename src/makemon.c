@@ -15,7 +15,13 @@
      && (mptr->msound == MS_LEADER || mptr->msound == MS_NEMESIS))
 
 static boolean uncommon(int);
-static int align_shift(struct permonst *);
+static boolean uncommon_type(int);
+static int level_align(void);
+static int align_shift(struct permonst *, int);
+static void rndmonst_build(int, int, int);
+#ifdef EXTRA_SANITY_CHECKS
+static void rndmonst_verify(void);
+#endif
 static boolean mk_gen_ok(int, unsigned, unsigned);
 static boolean wrong_elem_type(struct permonst *);
 static void m_initgrp(struct monst *, int, int, int, int);
@@ -1035,7 +1041,7 @@ newmextra(void)
 {
     struct mextra *mextra;
 
-    mextra = (struct mextra *) alloc(sizeof(struct mextra));
+    mextra = (struct mextra *) pool_get(POOL_MEXTRA);
     init_mextra(mextra);
     return mextra;
 }
@@ -1490,33 +1496,49 @@ create_critters(int cnt,
 static boolean
 uncommon(int mndx)
 {
-    if (mons[mndx].geno & (G_NOGEN | G_UNIQ))
-        return TRUE;
     if (g.mvitals[mndx].mvflags & G_GONE)
         return TRUE;
+    return uncommon_type(mndx);
+}
+
+/* the part of uncommon() which doesn't depend upon genocide/extinction */
+static boolean
+uncommon_type(int mndx)
+{
+    if (mons[mndx].geno & (G_NOGEN | G_UNIQ))
+        return TRUE;
     if (Inhell)
         return (boolean) (mons[mndx].maligntyp > A_NEUTRAL);
     else
         return (boolean) ((mons[mndx].geno & G_HELL) != 0);
 }
 
+/* alignment of the current dungeon or special level, for align_shift() */
+static int
+level_align(void)
+{
+    struct rndmonst_cache *rc = &g.rndmonst_cache;
+
+    /* align_moves starts out as 0, which is never a valid value of moves */
+    if (rc->align_moves != g.moves) {
+        rc->align_lev = Is_special(&u.uz);
+        rc->align_moves = g.moves;
+    }
+    return (rc->align_lev) ? rc->align_lev->flags.align
+                           : g.dungeons[u.uz.dnum].flags.align;
+}
+
 /*
  *      shift the probability of a monster's generation by
  *      comparing the dungeon alignment and monster alignment.
  *      return an integer in the range of 0-5.
  */
 static int
-align_shift(register struct permonst *ptr)
+align_shift(register struct permonst *ptr, int lev_align)
 {
-    static NEARDATA long oldmoves = 0L; /* != 1, starting value of moves */
-    static NEARDATA s_level *lev;
     register int alshift;
 
-    if (oldmoves != g.moves) {
-        lev = Is_special(&u.uz);
-        oldmoves = g.moves;
-    }
-    switch ((lev) ? lev->flags.align : g.dungeons[u.uz.dnum].flags.align) {
+    switch (lev_align) {
     default: /* just in case */
     case AM_NONE:
         alshift = 0;
@@ -1534,28 +1556,26 @@ align_shift(register struct permonst *ptr)
     return alshift;
 }
 
-/* select a random monster type */
-struct permonst *
-rndmonst(void)
+/*
+ * Collect the monster types which rndmonst() can choose from, with their
+ * weights, for the current level and difficulty range.  The list only
+ * needs rebuilding when one of those changes.  Genocided and extinct
+ * types are left in; rndmonst() skips them when drawing, so the list
+ * doesn't need to be invalidated by genocide, extinction, or restore.
+ */
+static void
+rndmonst_build(int minmlev, int maxmlev, int lev_align)
 {
+    struct rndmonst_cache *rc = &g.rndmonst_cache;
     register struct permonst *ptr;
     register int mndx;
-    int weight, totalweight, selected_mndx, zlevel, minmlev, maxmlev;
+    int weight;
     boolean elemlevel, upper;
 
-    if (u.uz.dnum == quest_dnum && rn2(7) && (ptr = qt_montype()) != 0)
-        return ptr;
-
-    zlevel = level_difficulty();
-    minmlev = monmin_difficulty(zlevel);
-    maxmlev = monmax_difficulty(zlevel);
     upper = Is_rogue_level(&u.uz); /* prefer uppercase only on rogue level */
     elemlevel = In_endgame(&u.uz) && !Is_astralevel(&u.uz); /* elmntl plane */
 
-    /* amount processed so far */
-    totalweight = 0;
-    selected_mndx = NON_PM;
-
+    rc->ncand = 0;
     for (mndx = LOW_PM; mndx < SPECIAL_PM; ++mndx) {
         ptr = &mons[mndx];
 
@@ -1565,11 +1585,95 @@ rndmonst(void)
             continue;
         if (elemlevel && wrong_elem_type(ptr))
             continue;
-        if (uncommon(mndx))
+        if (uncommon_type(mndx))
             continue;
         if (Inhell && (ptr->geno & G_NOHELL))
             continue;
 
+        weight = (int) (ptr->geno & G_FREQ) + align_shift(ptr, lev_align);
+        if (weight < 0 || weight > 127) {
+            impossible("bad weight in rndmonst for mndx %d", mndx);
+            weight = 0;
+        }
+        /* a type with no weight can never be picked and rndmonst() makes
+           no rn2() call for it, so leave it out altogether */
+        if (weight > 0) {
+            rc->mndx[rc->ncand] = (short) mndx;
+            rc->weight[rc->ncand] = (schar) weight;
+            rc->ncand++;
+        }
+    }
+    assign_level(&rc->lev, &u.uz);
+    rc->minmlev = minmlev;
+    rc->maxmlev = maxmlev;
+    rc->align = lev_align;
+    rc->valid = TRUE;
+}
+
+#ifdef EXTRA_SANITY_CHECKS
+/* rebuild the candidate list from scratch and complain if the cached
+   one differs from it */
+static void
+rndmonst_verify(void)
+{
+    struct rndmonst_cache *rc = &g.rndmonst_cache;
+    short *oldmndx = (short *) alloc(sizeof rc->mndx);
+    schar *oldweight = (schar *) alloc(sizeof rc->weight);
+    int oldncand = rc->ncand;
+
+    (void) memcpy((genericptr_t) oldmndx, (genericptr_t) rc->mndx,
+                  sizeof rc->mndx);
+    (void) memcpy((genericptr_t) oldweight, (genericptr_t) rc->weight,
+                  sizeof rc->weight);
+    rndmonst_build(rc->minmlev, rc->maxmlev, rc->align);
+    if (rc->ncand != oldncand
+        || memcmp((genericptr_t) oldmndx, (genericptr_t) rc->mndx,
+                  oldncand * sizeof oldmndx[0])
+        || memcmp((genericptr_t) oldweight, (genericptr_t) rc->weight,
+                  oldncand * sizeof oldweight[0]))
+        impossible("rndmonst: stale candidate cache (%d vs %d types)",
+                   oldncand, rc->ncand);
+    free((genericptr_t) oldmndx);
+    free((genericptr_t) oldweight);
+}
+#endif /* EXTRA_SANITY_CHECKS */
+
+/* select a random monster type */
+struct permonst *
+rndmonst(void)
+{
+    struct rndmonst_cache *rc = &g.rndmonst_cache;
+    register struct permonst *ptr;
+    register int mndx, i;
+    int weight, totalweight, selected_mndx, zlevel, minmlev, maxmlev,
+        lev_align;
+
+    if (u.uz.dnum == quest_dnum && rn2(7) && (ptr = qt_montype()) != 0)
+        return ptr;
+
+    zlevel = level_difficulty();
+    minmlev = monmin_difficulty(zlevel);
+    maxmlev = monmax_difficulty(zlevel);
+    lev_align = level_align();
+
+    if (!rc->valid || !on_level(&rc->lev, &u.uz)
+        || rc->minmlev != minmlev || rc->maxmlev != maxmlev
+        || rc->align != lev_align)
+        rndmonst_build(minmlev, maxmlev, lev_align);
+#ifdef EXTRA_SANITY_CHECKS
+    else
+        rndmonst_verify();
+#endif
+
+    /* amount processed so far */
+    totalweight = 0;
+    selected_mndx = NON_PM;
+
+    for (i = 0; i < rc->ncand; ++i) {
+        mndx = rc->mndx[i];
+        if (g.mvitals[mndx].mvflags & G_GONE)
+            continue;
+
         /*
          * Weighted reservoir sampling:  select ptr with a
          * (ptr weight)/(total of all weights so far including ptr's)
@@ -1582,19 +1686,15 @@ rndmonst(void)
          * later monsters:  the smaller pool and better odds from being
          * earlier are exactly canceled out by having more monsters to
          * potentially steal its spot.
+         *
+         * The candidate list only holds types with weight > 0, in mons[]
+         * order, so this makes exactly the same rn2() calls as checking
+         * every type would.
          */
-        weight = (int) (ptr->geno & G_FREQ) + align_shift(ptr);
-        if (weight < 0 || weight > 127) {
-            impossible("bad weight in rndmonst for mndx %d", mndx);
-            weight = 0;
-        }
-        /* was unconditional, but if weight==0, rn2() < 0 will always fail;
-           also need to avoid rn2(0) if totalweight is still 0 so far */
-        if (weight > 0) {
-            totalweight += weight; /* totalweight now guaranteed to be > 0 */
-            if (rn2(totalweight) < weight)
-                selected_mndx = mndx;
-        }
+        weight = rc->weight[i];
+        totalweight += weight; /* totalweight now guaranteed to be > 0 */
+        if (rn2(totalweight) < weight)
+            selected_mndx = mndx;
     }
     /*
      * Possible modification:  if totalweight is "too low" or nothing
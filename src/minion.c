@@ -11,7 +11,7 @@ newemin(struct monst *mtmp)
     if (!mtmp->mextra)
         mtmp->mextra = newmextra();
     if (!EMIN(mtmp)) {
-        EMIN(mtmp) = (struct emin *) alloc(sizeof(struct emin));
+        EMIN(mtmp) = (struct emin *) pool_get(POOL_EMIN);
         (void) memset((genericptr_t) EMIN(mtmp), 0, sizeof(struct emin));
     }
 }
@@ -20,7 +20,7 @@ void
 free_emin(struct monst *mtmp)
 {
     if (mtmp->mextra && EMIN(mtmp)) {
-        free((genericptr_t) EMIN(mtmp));
+        pool_put(POOL_EMIN, EMIN(mtmp));
         EMIN(mtmp) = (struct emin *) 0;
     }
     mtmp->isminion = 0;
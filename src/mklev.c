@@ -679,6 +679,8 @@ clear_level_structures(void)
             g.level.monsters[x][y] = (struct monst *) 0;
         }
     }
+    (void) memset((genericptr_t) g.level.objbuckets, 0,
+                  sizeof g.level.objbuckets);
     g.level.objlist = (struct obj *) 0;
     g.level.buriedobjlist = (struct obj *) 0;
     g.level.monlist = (struct monst *) 0;
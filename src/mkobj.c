@@ -9,6 +9,11 @@ static void mkbox_cnts(struct obj *);
 static unsigned nextoid(struct obj *, struct obj *);
 static void maybe_adjust_light(struct obj *, int);
 static void obj_timer_checks(struct obj *, xchar, xchar, int);
+static void recount_obj_bucket(int, int);
+static void obj_bucket_add(struct obj *);
+static void obj_bucket_del(xchar, xchar, int);
+static void area_hit(struct obj *, int);
+static void obj_bucket_sanity(void);
 static void container_weight(struct obj *);
 static struct obj *save_mtraits(struct obj *, struct monst *);
 static void objlist_sanity(struct obj *, int, const char *);
@@ -79,7 +84,7 @@ newoextra(void)
 {
     struct oextra *oextra;
 
-    oextra = (struct oextra *) alloc(sizeof (struct oextra));
+    oextra = (struct oextra *) pool_get(POOL_OEXTRA);
     init_oextra(oextra);
     return oextra;
 }
@@ -97,7 +102,7 @@ dealloc_oextra(struct obj* o)
         if (x->omailcmd)
             free((genericptr_t) x->omailcmd);
 
-        free((genericptr_t) x);
+        pool_put(POOL_OEXTRA, x);
         o->oextra = (struct oextra *) 0;
     }
 }
@@ -125,7 +130,7 @@ free_omonst(struct obj* otmp)
         if (m) {
             if (m->mextra)
                 dealloc_mextra(m);
-            free((genericptr_t) m);
+            pool_put(POOL_MONST, m);
             OMONST(otmp) = (struct monst *) 0;
         }
     }
@@ -402,8 +407,11 @@ splitobj(struct obj* obj, long num)
     obj->nobj = otmp;
     /* Only set nexthere when on the floor, nexthere is also used */
     /* as a back pointer to the container object when contained. */
-    if (obj->where == OBJ_FLOOR)
+    if (obj->where == OBJ_FLOOR) {
         obj->nexthere = otmp;
+        /* otmp shares obj's o_floorseq and follows it in both chains */
+        obj_bucket_add(otmp);
+    }
     copy_oextra(otmp, obj);
     if (has_omid(otmp))
         free_omid(otmp); /* only one association with m_id*/
@@ -552,10 +560,13 @@ replace_object(struct obj* obj, struct obj* otmp)
         otmp->nexthere = obj->nexthere;
         otmp->ox = obj->ox;
         otmp->oy = obj->oy;
+        otmp->o_floorseq = obj->o_floorseq; /* it takes obj's fobj slot */
         obj->nobj = otmp;
         obj->nexthere = otmp;
         extract_nobj(obj, &fobj);
         extract_nexthere(obj, &g.level.objects[obj->ox][obj->oy]);
+        obj_bucket_add(otmp);
+        obj_bucket_del(obj->ox, obj->oy, obj->oclass);
         break;
     default:
         panic("replace_object: obj position");
@@ -1733,6 +1744,76 @@ is_rottable(struct obj* otmp)
  * and threaded through the nexthere fields in the object-instance structure.
  */
 
+/* count the objects in one bucket of the floor object index from scratch */
+static void
+recount_obj_bucket(int bx, int by)
+{
+    struct obj_bucket *ob = &g.level.objbuckets[bx][by];
+    struct obj *otmp;
+    int x, y, lx = bx * OBJ_BUCKET_COLS, ly = by * OBJ_BUCKET_ROWS;
+
+    (void) memset((genericptr_t) ob, 0, sizeof *ob);
+    for (x = lx; x < lx + OBJ_BUCKET_COLS && x < COLNO; x++)
+        for (y = ly; y < ly + OBJ_BUCKET_ROWS && y < ROWNO; y++)
+            for (otmp = g.level.objects[x][y]; otmp; otmp = otmp->nexthere)
+                if (!ob->count[(int) otmp->oclass]++)
+                    ob->classes |= OCLASS_BIT(otmp->oclass);
+}
+
+/* note a newly placed floor object in the index */
+static void
+obj_bucket_add(struct obj *otmp)
+{
+    struct obj_bucket *ob = &g.level.objbuckets[otmp->ox / OBJ_BUCKET_COLS]
+                                               [otmp->oy / OBJ_BUCKET_ROWS];
+
+    if (!ob->count[(int) otmp->oclass]++)
+        ob->classes |= OCLASS_BIT(otmp->oclass);
+}
+
+/* drop an object of class oclass formerly at <x,y> from the index */
+static void
+obj_bucket_del(xchar x, xchar y, int oclass)
+{
+    int bx = x / OBJ_BUCKET_COLS, by = y / OBJ_BUCKET_ROWS;
+    struct obj_bucket *ob = &g.level.objbuckets[bx][by];
+
+    if (ob->count[oclass] > 0) {
+        if (!--ob->count[oclass])
+            ob->classes &= ~OCLASS_BIT(oclass);
+    } else {
+        /* index is out of step with the piles (shouldn't happen); the
+           object has already been unlinked so a recount fixes things */
+        recount_obj_bucket(bx, by);
+    }
+}
+
+/* change an object's class; a floor object moves from one class count
+   of its bucket to the other without having to leave its pile */
+void
+set_obj_class(struct obj *obj, int oclass)
+{
+    if (obj->where == OBJ_FLOOR) {
+        obj_bucket_del(obj->ox, obj->oy, obj->oclass);
+        obj->oclass = oclass;
+        obj_bucket_add(obj);
+    } else {
+        obj->oclass = oclass;
+    }
+}
+
+/* rebuild the whole floor object index; for when objects are shuffled
+   around without going through place_object() and remove_object() */
+void
+recalc_obj_buckets(void)
+{
+    int bx, by;
+
+    for (bx = 0; bx < OBJ_BUCKETS_X; bx++)
+        for (by = 0; by < OBJ_BUCKETS_Y; by++)
+            recount_obj_bucket(bx, by);
+}
+
 /* put the object at the given location */
 void
 place_object(struct obj* otmp, int x, int y)
@@ -1783,6 +1864,8 @@ place_object(struct obj* otmp, int x, int y)
     /* add to floor chain */
     otmp->nobj = fobj;
     fobj = otmp;
+    otmp->o_floorseq = ++g.floorseq;
+    obj_bucket_add(otmp);
     if (otmp->timed)
         obj_timer_checks(otmp, x, y, 0);
 }
@@ -1913,6 +1996,7 @@ remove_object(struct obj* otmp)
         panic("remove_object: obj not on floor");
     extract_nexthere(otmp, &g.level.objects[x][y]);
     extract_nobj(otmp, &fobj);
+    obj_bucket_del(x, y, otmp->oclass);
     /* update vision iff this was the only boulder at its spot */
     if (otmp->otyp == BOULDER && !sobj_at(BOULDER, x, y))
         unblock_point(x, y); /* vision */
@@ -1920,6 +2004,81 @@ remove_object(struct obj* otmp)
         obj_timer_checks(otmp, x, y, 0);
 }
 
+/* note one more result for first_obj_in_area() */
+static void
+area_hit(struct obj *otmp, int nhits)
+{
+    if (nhits >= g.area_hits_size) {
+        struct obj **newhits;
+        int newsize = max(2 * g.area_hits_size, 32);
+
+        newhits = (struct obj **) alloc((unsigned) newsize * sizeof *newhits);
+        if (g.area_hits) {
+            (void) memcpy((genericptr_t) newhits, (genericptr_t) g.area_hits,
+                          (size_t) nhits * sizeof *newhits);
+            free((genericptr_t) g.area_hits);
+        }
+        g.area_hits = newhits;
+        g.area_hits_size = newsize;
+    }
+    g.area_hits[nhits] = otmp;
+}
+
+/* start iterating over the floor objects of the given classes (a mask of
+   OCLASS_BIT()s) lying within <lx,ly>..<hx,hy>.  Only buckets holding
+   some of those classes are looked at, but the objects are returned in
+   the same order as a walk of fobj would find them, so that callers who
+   use the RNG as they go behave exactly as such a walk did.  The results
+   are gathered up front into a shared buffer, so iterations can't be
+   nested and objects mustn't be removed from the floor in between. */
+struct obj *
+first_obj_in_area(struct obj_area *oa, int lx, int ly, int hx, int hy,
+                  unsigned long classes)
+{
+    struct obj *otmp;
+    int x, y, by, i, j;
+
+    oa->nhits = oa->next = 0;
+    lx = max(lx, 0), hx = min(hx, COLNO - 1);
+    ly = max(ly, 0), hy = min(hy, ROWNO - 1);
+    for (x = lx; x <= hx; x++)
+        for (y = ly; y <= hy; y++) {
+            by = y / OBJ_BUCKET_ROWS;
+            if (!(g.level.objbuckets[x / OBJ_BUCKET_COLS][by].classes
+                  & classes)) {
+                /* nothing wanted here; skip this column's share of it */
+                y = (by + 1) * OBJ_BUCKET_ROWS - 1;
+                continue;
+            }
+            for (otmp = g.level.objects[x][y]; otmp; otmp = otmp->nexthere)
+                if (classes & OCLASS_BIT(otmp->oclass))
+                    area_hit(otmp, oa->nhits++);
+        }
+    oa->hits = g.area_hits;
+
+    /* fobj is in decreasing o_floorseq order, apart from splitobj()'s
+       pieces which share their parent's and follow it in the pile too, so
+       the sort has to be stable; there are usually only a few results, so
+       an insertion sort does */
+    for (i = 1; i < oa->nhits; i++) {
+        otmp = oa->hits[i];
+        for (j = i; j > 0 && oa->hits[j - 1]->o_floorseq < otmp->o_floorseq;
+             j--)
+            oa->hits[j] = oa->hits[j - 1];
+        oa->hits[j] = otmp;
+    }
+    return next_obj_in_area(oa);
+}
+
+/* continue an iteration begun by first_obj_in_area() */
+struct obj *
+next_obj_in_area(struct obj_area *oa)
+{
+    if (oa->next >= oa->nhits)
+        return (struct obj *) 0;
+    return oa->hits[oa->next++];
+}
+
 /* throw away all of a monster's inventory */
 void
 discard_minvent(struct monst* mtmp, boolean uncreate_artifacts)
@@ -2171,7 +2330,7 @@ dealloc_obj(struct obj* obj)
         obj->where = OBJ_LUAFREE;
         return;
     }
-    free((genericptr_t) obj);
+    pool_put(POOL_OBJ, obj);
 }
 
 /* create an object from a horn of plenty; mirrors bagotricks(makemon.c) */
@@ -2291,6 +2450,8 @@ obj_sanity_check(void)
                 }
             }
 
+    obj_bucket_sanity();
+
     objlist_sanity(g.invent, OBJ_INVENT, "invent sanity");
     objlist_sanity(g.migrating_objs, OBJ_MIGRATING, "migrating sanity");
     objlist_sanity(g.level.buriedobjlist, OBJ_BURIED, "buried sanity");
@@ -2320,6 +2481,42 @@ obj_sanity_check(void)
                       (struct monst *) 0);
 }
 
+/* check that the floor object index agrees with the map's object piles */
+static void
+obj_bucket_sanity(void)
+{
+    int counts[OBJ_BUCKETS_X][OBJ_BUCKETS_Y][MAXOCLASSES];
+    struct obj_bucket *ob;
+    struct obj *obj;
+    int x, y, c;
+
+    (void) memset((genericptr_t) counts, 0, sizeof counts);
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++)
+            for (obj = g.level.objects[x][y]; obj; obj = obj->nexthere)
+                counts[x / OBJ_BUCKET_COLS][y / OBJ_BUCKET_ROWS]
+                      [(int) obj->oclass]++;
+
+    for (x = 0; x < OBJ_BUCKETS_X; x++)
+        for (y = 0; y < OBJ_BUCKETS_Y; y++) {
+            ob = &g.level.objbuckets[x][y];
+            for (c = 0; c < MAXOCLASSES; c++)
+                if (ob->count[c] != counts[x][y][c]
+                    || !(ob->classes & OCLASS_BIT(c)) != !counts[x][y][c])
+                    impossible(
+                    "object index bucket <%d,%d> class %d: %d, expected %d",
+                               x, y, c, ob->count[c], counts[x][y][c]);
+        }
+
+    /* first_obj_in_area() relies on this to reproduce fobj's order */
+    for (obj = fobj; obj && obj->nobj; obj = obj->nobj)
+        if (obj->nobj->o_floorseq > obj->o_floorseq) {
+            impossible("fobj out of o_floorseq order (%lu, then %lu)",
+                       obj->o_floorseq, obj->nobj->o_floorseq);
+            break;
+        }
+}
+
 /* sanity check for objects on specified list (fobj, &c) */
 static void
 objlist_sanity(struct obj* objlist, int wheretype, const char * mesg)
@@ -2155,18 +2155,18 @@ dealloc_mextra(struct monst* m)
         if (x->mgivenname)
             free((genericptr_t) x->mgivenname);
         if (x->egd)
-            free((genericptr_t) x->egd);
+            pool_put(POOL_EGD, x->egd);
         if (x->epri)
-            free((genericptr_t) x->epri);
+            pool_put(POOL_EPRI, x->epri);
         if (x->eshk)
-            free((genericptr_t) x->eshk);
+            pool_put(POOL_ESHK, x->eshk);
         if (x->emin)
-            free((genericptr_t) x->emin);
+            pool_put(POOL_EMIN, x->emin);
         if (x->edog)
-            free((genericptr_t) x->edog);
+            pool_put(POOL_EDOG, x->edog);
         /* [no action needed for x->mcorpsenm] */
 
-        free((genericptr_t) x);
+        pool_put(POOL_MEXTRA, x);
         m->mextra = (struct mextra *) 0;
     }
 }
@@ -2183,7 +2183,7 @@ dealloc_monst(struct monst* mon)
     }
     if (mon->mextra)
         dealloc_mextra(mon);
-    free((genericptr_t) mon);
+    pool_put(POOL_MONST, mon);
 }
 
 /* remove effects of mtmp from other data structures */
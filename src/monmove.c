@@ -1070,6 +1070,8 @@ m_move(register struct monst* mtmp, register int after)
         register struct obj *otmp;
         register int xx, yy;
         int oomx, oomy, lmx, lmy;
+        unsigned long wanted;
+        struct obj_area oa;
 
         /* cut down the search radius if it thinks character is closer. */
         if (distmin(mtmp->mux, mtmp->muy, omx, omy) < SQSRCHRADIUS
@@ -1087,7 +1089,14 @@ m_move(register struct monst* mtmp, register int after)
             oomy = min(ROWNO - 1, omy + minr);
             lmx = max(1, omx - minr);
             lmy = max(0, omy - minr);
-            for (otmp = fobj; otmp; otmp = otmp->nobj) {
+            /* gold-only searches can skip areas without any coins */
+            wanted = (uses_items || likegems || likeobjs || likemagic
+                      || likerock || conceals
+                      || ptr == &mons[PM_GELATINOUS_CUBE])
+                         ? ALL_OCLASS_BITS
+                         : OCLASS_BIT(COIN_CLASS);
+            for (otmp = first_obj_in_area(&oa, lmx, lmy, oomx, oomy, wanted);
+                 otmp; otmp = next_obj_in_area(&oa)) {
                 /* monsters may pick rocks up, but won't go out of their way
                    to grab them; this might hamper sling wielders, but it cuts
                    down on move overhead by filtering out most common item */
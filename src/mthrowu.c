@@ -9,6 +9,7 @@ static int monmulti(struct monst *, struct obj *, struct obj *);
 static void monshoot(struct monst *, struct obj *, struct obj *);
 static int drop_throw(struct obj *, boolean, int, int);
 static int m_lined_up(struct monst *, struct monst *);
+static boolean linedup_from(struct monst *, xchar, xchar, xchar, xchar, int);
 
 #define URETREATING(x, y) \
     (distmin(u.ux, u.uy, x, y) > distmin(u.ux0, u.uy0, x, y))
@@ -1011,6 +1012,19 @@ linedup(
     register xchar bx,
     register xchar by,
     int boulderhandling) /* 0=block, 1=ignore, 2=conditionally block */
+{
+    return linedup_from((struct monst *) 0, ax, ay, bx, by, boulderhandling);
+}
+
+/* linedup(); if mon is non-Null, it is the monster at <bx,by> */
+static boolean
+linedup_from(
+    struct monst *mon,
+    xchar ax,
+    xchar ay,
+    xchar bx,
+    xchar by,
+    int boulderhandling)
 {
     int dx, dy, boulderspots;
 
@@ -1026,7 +1040,8 @@ linedup(
     if ((!g.tbx || !g.tby || abs(g.tbx) == abs(g.tby)) /* straight line or diagonal */
         && distmin(g.tbx, g.tby, 0, 0) < BOLT_LIM) {
         if ((ax == u.ux && ay == u.uy) ? (boolean) couldsee(bx, by)
-                                       : clear_path(ax, ay, bx, by))
+            : mon ? mon_clear_path(mon, ax, ay)
+            : clear_path(ax, ay, bx, by))
             return TRUE;
         /* don't have line of sight, but might still be lined up
            if that lack of sight is due solely to boulders */
@@ -1065,8 +1080,8 @@ m_lined_up(struct monst* mtarg, struct monst* mtmp)
         return FALSE;
 
     /* [no callers care about the 1 vs 2 situation any more] */
-    return linedup(tx, ty, mtmp->mx, mtmp->my,
-                   utarget ? (ignore_boulders ? 1 : 2) : 0);
+    return linedup_from(mtmp, tx, ty, mtmp->mx, mtmp->my,
+                        utarget ? (ignore_boulders ? 1 : 2) : 0);
 }
 
 
@@ -13,6 +13,7 @@ static int l_selection_setpoint(lua_State *);
 static int l_selection_not(lua_State *);
 static int l_selection_filter_percent(lua_State *);
 static int l_selection_rndcoord(lua_State *);
+static int l_selection_numpoints(lua_State *);
 static boolean params_sel_2coords(lua_State *, struct selectionvar **,
                                   xchar *, xchar *, xchar *, xchar *);
 static int l_selection_line(lua_State *);
@@ -90,9 +91,8 @@ l_selection_push(lua_State *L)
     luaL_getmetatable(L, "selection");
     lua_setmetatable(L, -2);
 
-    sel->wid = tmp->wid;
-    sel->hei = tmp->hei;
-    sel->map = dupstr(tmp->map);
+    sel->map = NULL;
+    selection_copy(sel, tmp);
     selection_free(tmp, TRUE);
 
     return sel;
@@ -116,11 +116,7 @@ l_selection_clone(lua_State *L)
 
     (void) l_selection_new(L);
     tmp = l_selection_check(L, 2);
-    if (tmp->map)
-        free(tmp->map);
-    tmp->map = dupstr(sel->map);
-    tmp->wid = sel->wid;
-    tmp->hei = sel->hei;
+    selection_copy(tmp, sel);
     return 1;
 }
 
@@ -221,16 +217,11 @@ l_selection_not(lua_State *L)
 static int
 l_selection_and(lua_State *L)
 {
-    int x,y;
     struct selectionvar *sela = l_selection_check(L, 1);
     struct selectionvar *selb = l_selection_check(L, 2);
     struct selectionvar *selr = l_selection_push(L);
 
-    for (x = 0; x < selr->wid; x++)
-        for (y = 0; y < selr->hei; y++) {
-            int val = selection_getpoint(x, y, sela) & selection_getpoint(x, y, selb);
-            selection_setpoint(x, y, selr, val);
-        }
+    selection_and(selr, sela, selb);
 
     lua_remove(L, 1);
     lua_remove(L, 1);
@@ -241,16 +232,11 @@ l_selection_and(lua_State *L)
 static int
 l_selection_or(lua_State *L)
 {
-    int x,y;
     struct selectionvar *sela = l_selection_check(L, 1);
     struct selectionvar *selb = l_selection_check(L, 2);
     struct selectionvar *selr = l_selection_push(L);
 
-    for (x = 0; x < selr->wid; x++)
-        for (y = 0; y < selr->hei; y++) {
-            int val = selection_getpoint(x, y, sela) | selection_getpoint(x, y, selb);
-            selection_setpoint(x, y, selr, val);
-        }
+    selection_or(selr, sela, selb);
 
     lua_remove(L, 1);
     lua_remove(L, 1);
@@ -261,16 +247,11 @@ l_selection_or(lua_State *L)
 static int
 l_selection_xor(lua_State *L)
 {
-    int x,y;
     struct selectionvar *sela = l_selection_check(L, 1);
     struct selectionvar *selb = l_selection_check(L, 2);
     struct selectionvar *selr = l_selection_push(L);
 
-    for (x = 0; x < selr->wid; x++)
-        for (y = 0; y < selr->hei; y++) {
-            int val = selection_getpoint(x, y, sela) ^ selection_getpoint(x, y, selb);
-            selection_setpoint(x, y, selr, val);
-        }
+    selection_xor(selr, sela, selb);
 
     lua_remove(L, 1);
     lua_remove(L, 1);
@@ -295,6 +276,18 @@ l_selection_filter_percent(lua_State *L)
     return 1;
 }
 
+/* local n = selection.numpoints(sel); */
+/* local n = sel:numpoints(); */
+static int
+l_selection_numpoints(lua_State *L)
+{
+    struct selectionvar *sel = l_selection_check(L, 1);
+
+    lua_settop(L, 0);
+    lua_pushinteger(L, selection_numpoints(sel));
+    return 1;
+}
+
 /* local x,y = selection.rndcoord(sel); */
 /* local x,y = selection.rndcoord(sel, 1); */
 static int
@@ -517,9 +510,7 @@ l_selection_filter_mapchar(lua_State *L)
     tmp = l_selection_push(L);
     tmp2 = selection_filter_mapchar(sel, typ, lit);
 
-    free(tmp->map);
-    tmp->map = tmp2->map;
-    tmp2->map = NULL;
+    selection_copy(tmp, tmp2);
     selection_free(tmp2, TRUE);
 
     lua_remove(L, 1);
@@ -795,6 +786,7 @@ static const struct luaL_Reg l_selection_methods[] = {
     { "negate", l_selection_not },
     { "percentage", l_selection_filter_percent },
     { "rndcoord", l_selection_rndcoord },
+    { "numpoints", l_selection_numpoints },
     { "line", l_selection_line },
     { "randline", l_selection_randline },
     { "rect", l_selection_rect },
@@ -17,7 +17,6 @@
 static int nhl_test(lua_State *);
 static int nhl_getmap(lua_State *);
 static void nhl_add_table_entry_bool(lua_State *, const char *, boolean);
-static char splev_typ2chr(schar);
 static int nhl_gettrap(lua_State *);
 static int nhl_deltrap(lua_State *);
 #if 0
@@ -45,6 +44,13 @@ static int nhl_u_giveobj(lua_State *);
 static void init_u_data(lua_State *);
 static int nhl_set_package_path(lua_State *, const char *);
 static int traceback_handler(lua_State *);
+static boolean nhl_loadbytecode(lua_State *, const char *, const char *);
+static boolean nhl_loadchunk(lua_State *, const char *);
+static lua_State *nhl_newstate(void);
+static int nhl_dump_writer(lua_State *, const void *, size_t, void *);
+static lua_State *nhl_core(void);
+static void nhl_push_sandbox(lua_State *);
+static boolean nhl_sandbox_call(lua_State *, int);
 
 void
 nhl_error(lua_State *L, const char *msg)
@@ -211,7 +217,7 @@ check_mapchr(const char *s)
     return INVALID_TYPE;
 }
 
-static char
+char
 splev_typ2chr(schar typ)
 {
     int i;
@@ -998,6 +1004,65 @@ traceback_handler(lua_State *L)
    into a string buffer and feed that to lua */
 boolean
 nhl_loadlua(lua_State *L, const char *fname)
+{
+    if (!nhl_loadchunk(L, fname))
+        return FALSE;
+
+    lua_pushcfunction(L, traceback_handler);
+    lua_insert(L, 1);
+    if (lua_pcall(L, 0, LUA_MULTRET, -2)) {
+        impossible("Lua error: %s", lua_tostring(L, -1));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* try to load the precompiled form of 'fname' made by util/nhluac,
+   leaving the resulting function on top of the lua stack; fails quietly
+   if there isn't one or its stamp is from some other build */
+static boolean
+nhl_loadbytecode(lua_State *L, const char *fname, const char *altfname)
+{
+    boolean ret = FALSE;
+    dlb *fh;
+    char *buf, *cname, stamp[LUAC_STAMPSZ];
+    long buflen, stamplen;
+
+    cname = (char *) alloc(strlen(fname) + sizeof LUAC_SUFFIX);
+    Strcat(strcpy(cname, fname), LUAC_SUFFIX);
+    fh = dlb_fopen(cname, RDBMODE);
+    free((genericptr_t) cname);
+    if (!fh)
+        return FALSE;
+
+    dlb_fseek(fh, 0L, SEEK_END);
+    buflen = dlb_ftell(fh);
+    dlb_fseek(fh, 0L, SEEK_SET);
+    make_luac_stamp(stamp);
+    stamplen = (long) strlen(stamp);
+
+    buf = (char *) alloc(buflen + 1);
+    if (buflen > stamplen
+        && dlb_fread(buf, 1, (int) buflen, fh) == (int) buflen
+        && !strncmp(buf, stamp, (size_t) stamplen)) {
+        /* the chunk name is part of the dump; altfname only matters
+           if lua rejects it, and then we fall back to the source */
+        if (luaL_loadbufferx(L, buf + stamplen, (size_t) (buflen - stamplen),
+                             altfname, "b") == LUA_OK)
+            ret = TRUE;
+        else
+            lua_pop(L, 1); /* error message */
+    }
+    (void) dlb_fclose(fh);
+    free((genericptr_t) buf);
+    return ret;
+}
+
+/* read lua code/data from a dlb module or an external file and compile
+   it, leaving the resulting function on top of the lua stack; uses the
+   precompiled form instead if there's a usable one */
+static boolean
+nhl_loadchunk(lua_State *L, const char *fname)
 {
 #define LOADCHUNKSIZE (1L << 13) /* 8K */
     boolean ret = TRUE;
@@ -1011,6 +1076,9 @@ nhl_loadlua(lua_State *L, const char *fname)
        if we did, we could choose between "nhdat(<fname>)" and "<fname>"
        but since we don't, compromise */
     Sprintf(altfname, "(%s)", fname);
+    if (nhl_loadbytecode(L, fname, altfname))
+        goto give_up; /* not actually giving up; ret is TRUE */
+
     fh = dlb_fopen(fname, "r");
     if (!fh) {
         impossible("nhl_loadlua: Error loading %s", altfname);
@@ -1088,14 +1156,6 @@ nhl_loadlua(lua_State *L, const char *fname)
                    altfname, lua_tostring(L, -1));
         ret = FALSE;
         goto give_up;
-    } else {
-        lua_pushcfunction(L, traceback_handler);
-        lua_insert(L, 1);
-        if (lua_pcall(L, 0, LUA_MULTRET, -2)) {
-            impossible("Lua error: %s", lua_tostring(L, -1));
-            ret = FALSE;
-            goto give_up;
-        }
     }
 
  give_up:
@@ -1106,12 +1166,13 @@ nhl_loadlua(lua_State *L, const char *fname)
     return ret;
 }
 
-lua_State *
-nhl_init(void)
+/* create a lua state with the standard libraries and all of nethack's
+   tables registered, but without nhlib.lua having been run */
+static lua_State *
+nhl_newstate(void)
 {
     lua_State *L = luaL_newstate();
 
-    iflags.in_lua = TRUE;
     luaL_openlibs(L);
     nhl_set_package_path(L, "./?.lua");
 
@@ -1131,6 +1192,17 @@ nhl_init(void)
 
     l_obj_register(L);
 
+    return L;
+}
+
+lua_State *
+nhl_init(void)
+{
+    lua_State *L;
+
+    iflags.in_lua = TRUE;
+    L = nhl_newstate();
+
     if (!nhl_loadlua(L, "nhlib.lua")) {
         nhl_done(L);
         return (lua_State *) 0;
@@ -1146,25 +1218,145 @@ nhl_done(lua_State *L)
     iflags.in_lua = FALSE;
 }
 
-boolean
-load_lua(const char *name)
+/*
+ * Special level scripts are all run in one long-lived "core" lua state
+ * instead of building and tearing down a new interpreter for each one.
+ * Every script gets a fresh globals table which falls back to the core
+ * state's real globals for the standard libraries and for the nh, nhc,
+ * u, selection, des and obj tables, so nothing one level defines is
+ * visible to the next.
+ *
+ * nhlib.lua is compiled once and kept as a precompiled chunk; its body
+ * is run again in each new globals table.  That matters for more than
+ * just defining its functions there:  it shuffles 'align', so re-running
+ * it keeps the rn2() sequence exactly as it was with a brand new state.
+ */
+
+/* lua_dump() callback; accumulates the precompiled nhlib chunk, with
+   *ud holding the size of the buffer, which is doubled as needed since
+   lua_dump() hands over its output in many small pieces */
+static int
+nhl_dump_writer(lua_State *L UNUSED, const void *p, size_t sz, void *ud)
 {
-    boolean ret = TRUE;
-    lua_State *L = nhl_init();
+    size_t *bufsize = (size_t *) ud, need = g.luacore_nhlib_len + sz;
+    char *newbuf;
+
+    if (need > *bufsize) {
+        *bufsize = max(*bufsize * 2, max(need, (size_t) BUFSZ));
+        newbuf = (char *) alloc((unsigned) *bufsize);
+        if (g.luacore_nhlib) {
+            (void) memcpy(newbuf, g.luacore_nhlib, g.luacore_nhlib_len);
+            free((genericptr_t) g.luacore_nhlib);
+        }
+        g.luacore_nhlib = newbuf;
+    }
+    (void) memcpy(g.luacore_nhlib + g.luacore_nhlib_len, p, sz);
+    g.luacore_nhlib_len = need;
+    return 0;
+}
+
+/* return the core state, creating it on first use */
+static lua_State *
+nhl_core(void)
+{
+    lua_State *L = (lua_State *) g.luacore;
+    size_t bufsize = 0;
 
     if (!L) {
-        ret = FALSE;
-        goto give_up;
+        L = nhl_newstate();
+        if (!nhl_loadchunk(L, "nhlib.lua")
+            || lua_dump(L, nhl_dump_writer, (void *) &bufsize, 0) != 0) {
+            lua_close(L);
+            nhl_core_done();
+            return (lua_State *) 0;
+        }
+        lua_settop(L, 0);
+        g.luacore = (genericptr_t) L;
+    }
+    return L;
+}
+
+void
+nhl_core_done(void)
+{
+    if (g.luacore) {
+        lua_close((lua_State *) g.luacore);
+        g.luacore = (genericptr_t) 0;
+    }
+    if (g.luacore_nhlib) {
+        free((genericptr_t) g.luacore_nhlib);
+        g.luacore_nhlib = (char *) 0;
     }
+    g.luacore_nhlib_len = 0;
+}
 
-    if (!nhl_loadlua(L, name)) {
-        ret = FALSE;
+/* push a new, empty globals table whose lookups fall through to the
+   core state's real globals */
+static void
+nhl_push_sandbox(lua_State *L)
+{
+    lua_newtable(L);
+    lua_newtable(L); /* its metatable */
+    lua_pushglobaltable(L);
+    lua_setfield(L, -2, "__index");
+    lua_setmetatable(L, -2);
+}
+
+/* run the chunk on top of the stack with the table at 'envidx' as its
+   globals; the chunk is popped, as is its error message on failure */
+static boolean
+nhl_sandbox_call(lua_State *L, int envidx)
+{
+    int fidx = lua_gettop(L);
+
+    /* a main chunk's first and only upvalue is _ENV */
+    lua_pushvalue(L, envidx);
+    if (!lua_setupvalue(L, fidx, 1))
+        lua_pop(L, 1);
+
+    lua_pushcfunction(L, traceback_handler);
+    lua_insert(L, fidx);
+    if (lua_pcall(L, 0, 0, fidx)) {
+        impossible("Lua error: %s", lua_tostring(L, -1));
+        lua_settop(L, fidx - 1);
+        return FALSE;
+    }
+    lua_settop(L, fidx - 1);
+    return TRUE;
+}
+
+boolean
+load_lua(const char *name)
+{
+    boolean ret = FALSE, was_in_lua = iflags.in_lua;
+    lua_State *L;
+    int top, env;
+
+    iflags.in_lua = TRUE;
+    if (!(L = nhl_core()))
         goto give_up;
+
+    top = lua_gettop(L);
+    nhl_push_sandbox(L);
+    env = lua_gettop(L);
+
+    if (luaL_loadbufferx(L, g.luacore_nhlib, g.luacore_nhlib_len,
+                         "(nhlib.lua)", "b") != LUA_OK) {
+        impossible("luaL_loadbuffer: Error loading (nhlib.lua): %s",
+                   lua_tostring(L, -1));
+    } else if (nhl_sandbox_call(L, env)
+               && nhl_loadchunk(L, name)
+               && nhl_sandbox_call(L, env)) {
+        ret = TRUE;
     }
+    lua_settop(L, top);
+    /* the script's globals table is garbage now; collect it so that the
+       __gc of any obj it held runs for this level rather than whenever
+       the core state next gets around to it */
+    (void) lua_gc(L, LUA_GCCOLLECT, 0);
 
  give_up:
-    nhl_done(L);
-
+    iflags.in_lua = was_in_lua;
     return ret;
 }
 
@@ -2602,6 +2602,40 @@ optfn_race(int optidx, int req, boolean negated, char *opts, char *op)
     return optn_ok;
 }
 
+static int
+optfn_rng_profile(int optidx, int req, boolean negated, char *opts, char *op)
+{
+    if (req == do_init) {
+        return optn_ok;
+    }
+    if (req == do_set) {
+        /* rng_profile: classic | fast; a restored game keeps its own */
+        if (op != empty_optstr && !negated) {
+            if (!strncmpi(op, "classic", strlen(op)))
+                flags.rng_profile = RNG_CLASSIC;
+            else if (!strncmpi(op, "fast", strlen(op)))
+                flags.rng_profile = RNG_FAST;
+            else {
+                config_error_add("Unknown %s parameter '%s'",
+                                 allopt[optidx].name, op);
+                return optn_err;
+            }
+        } else {
+            config_error_add("Value is mandatory for %s", allopt[optidx].name);
+            return optn_err;
+        }
+        return optn_ok;
+    }
+    if (req == get_val) {
+        if (!opts)
+            return optn_err;
+        Sprintf(opts, "%s",
+                (flags.rng_profile == RNG_FAST) ? "fast" : "classic");
+        return optn_ok;
+    }
+    return optn_ok;
+}
+
 static int
 optfn_roguesymset(int optidx, int req, boolean negated UNUSED,
                   char *opts, char *op)
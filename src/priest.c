@@ -18,7 +18,7 @@ newepri(struct monst *mtmp)
     if (!mtmp->mextra)
         mtmp->mextra = newmextra();
     if (!EPRI(mtmp)) {
-        EPRI(mtmp) = (struct epri *) alloc(sizeof(struct epri));
+        EPRI(mtmp) = (struct epri *) pool_get(POOL_EPRI);
         (void) memset((genericptr_t) EPRI(mtmp), 0, sizeof(struct epri));
     }
 }
@@ -27,7 +27,7 @@ void
 free_epri(struct monst *mtmp)
 {
     if (mtmp->mextra && EPRI(mtmp)) {
-        free((genericptr_t) EPRI(mtmp));
+        pool_put(POOL_EPRI, EPRI(mtmp));
         EPRI(mtmp) = (struct epri *) 0;
     }
     mtmp->ispriest = 0;
@@ -75,6 +75,8 @@ find_lev_obj(void)
     for (x = 0; x < COLNO; x++)
         for (y = 0; y < ROWNO; y++)
             g.level.objects[x][y] = (struct obj *) 0;
+    (void) memset((genericptr_t) g.level.objbuckets, 0,
+                  sizeof g.level.objbuckets);
 
     /*
      * Reverse the entire fobj chain, which is necessary so that we can
@@ -756,6 +758,8 @@ dorecover(NHFILE* nhfp)
 
     g.program_state.restoring = 1;
     get_plname_from_file(nhfp, g.plname);
+    if (nhfp->structlevel && (sfrestinfo.sfi1 & SFI1_LZCOMP))
+        lzon(nhfp->fd, TRUE);
     getlev(nhfp, 0, (xchar) 0);
     if (!restgamestate(nhfp, &stuckid, &steedid)) {
         NHFILE tnhfp;
@@ -838,6 +842,8 @@ dorecover(NHFILE* nhfp)
     rewind_nhfile(nhfp);        /* return to beginning of file */
     (void) validate(nhfp, (char *) 0);
     get_plname_from_file(nhfp, g.plname);
+    if (nhfp->structlevel && (sfrestinfo.sfi1 & SFI1_LZCOMP))
+        lzon(nhfp->fd, TRUE);
 
     getlev(nhfp, 0, (xchar) 0);
     close_nhfile(nhfp);
@@ -888,6 +894,63 @@ dorecover(NHFILE* nhfp)
     return 1;
 }
 
+/* put the game back the way it was when snapshot_take() (save.c) made
+   'snap'; the snapshot itself is left as it is, to be restored again */
+void
+snapshot_restore(struct snapshot *snap)
+{
+    NHFILE nhf;
+    struct obj *otmp;
+    struct savefile_info sfsave;
+    unsigned int stuckid = 0, steedid = 0;
+    xchar ltmp;
+
+    /* other levels' files first, while level_info[] still describes the
+       files which are there now rather than the ones in the snapshot */
+    for (ltmp = 1; ltmp <= maxledgerno(); ltmp++) {
+        if (ltmp == snap->ledger || !snap->levels[ltmp])
+            delete_levelfile(ltmp);
+        else
+            snaplevel_put(ltmp, snap->levels[ltmp]);
+    }
+
+    g.program_state.restoring = 1;
+    /* nothing in progress refers into the objects about to be discarded */
+    reset_occupations();
+    g.occupation = 0, g.afternmv = 0;
+    g.multi = 0, g.nomovemsg = 0;
+    discard_gamestate();
+
+    zero_nhfile(&nhf);
+    nhf.structlevel = TRUE;
+    nhf.ftype = NHF_SAVEFILE;
+    nhf.mode = READING;
+    nhf.fd = memfile_open(snap->state, snap->statelen);
+    if (!restgamestate(&nhf, &stuckid, &steedid))
+        panic("snapshot_restore: bad game state");
+    /* the level was written with this game's own savefile settings */
+    sfsave = sfrestinfo;
+    sfrestinfo = sfsaveinfo;
+    getlev(&nhf, 0, snap->ledger);
+    sfrestinfo = sfsave;
+    rest_rngstate(&nhf);
+    (void) memfile_close(nhf.fd, (size_t *) 0);
+    restlevelstate(stuckid, steedid);
+
+    /* as dorecover() does from here, less what only applies to a game
+       coming back after an absence */
+    max_rank_sz();
+    for (otmp = fobj; otmp; otmp = otmp->nobj)
+        if (otmp->owornmask)
+            setworn(otmp, otmp->owornmask);
+    reglyph_darkroom();
+    vision_reset();
+    g.vision_full_recalc = 1;
+    g.defer_see_monsters = FALSE;
+    g.program_state.restoring = 0;
+    docrt();
+}
+
 static void
 rest_stairs(NHFILE* nhfp)
 {
@@ -1220,8 +1283,8 @@ get_plname_from_file(NHFILE* nhfp, char *plbuf)
     int pltmpsiz = 0;
 
     if (nhfp->structlevel) {
-        (void) read(nhfp->fd, (genericptr_t) &pltmpsiz, sizeof(pltmpsiz));
-        (void) read(nhfp->fd, (genericptr_t) plbuf, pltmpsiz);
+        (void) nhread(nhfp->fd, (genericptr_t) &pltmpsiz, sizeof(pltmpsiz));
+        (void) nhread(nhfp->fd, (genericptr_t) plbuf, pltmpsiz);
     }
     return;
 }
@@ -1422,10 +1485,15 @@ validate(NHFILE* nhfp, const char *name)
 
     if ((nhfp->mode & WRITING) == 0) {
 	if (nhfp->structlevel)
-            rlen = read(nhfp->fd, (genericptr_t) &sfi, sizeof sfi);
+            rlen = nhread(nhfp->fd, (genericptr_t) &sfi, sizeof sfi);
+        /* note whether what follows the header is compressed */
+        if (rlen == (int) sizeof sfi && (sfi.sfi1 & SFI1_LZCOMP))
+            sfrestinfo.sfi1 |= SFI1_LZCOMP;
+        else
+            sfrestinfo.sfi1 &= ~SFI1_LZCOMP;
     } else {
         if (nhfp->structlevel)
-            rlen = read(nhfp->fd, (genericptr_t) &sfi, sizeof sfi);
+            rlen = nhread(nhfp->fd, (genericptr_t) &sfi, sizeof sfi);
         minit();		/* ZEROCOMP */
         if (rlen == 0) {
 	    if (verbose) {
@@ -4,6 +4,18 @@
 
 #include "hack.h"
 
+#ifdef RNGTRACE
+/* extern.h wraps these to note their callers; the definitions here and
+   the calls among them mustn't be wrapped */
+#undef rn2
+#undef rnl
+#undef rnd
+#undef d
+#undef rne
+#undef rnz
+#undef rn2_on_display_rng
+#endif
+
 #ifdef USE_ISAAC64
 #include "isaac64.h"
 
@@ -17,15 +29,74 @@ struct rnglist_t {
     int (*fn)(int);
     boolean init;
     isaac64_ctx rng_state;
+    unsigned long draws; /* numbers taken from rng_state since seeding */
 };
 
 enum { CORE = 0, DISP = 1 };
 
 static struct rnglist_t rnglist[] = {
-    { rn2, FALSE, { 0 } },                      /* CORE */
-    { rn2_on_display_rng, FALSE, { 0 } },       /* DISP */
+    { rn2, FALSE, { 0 }, 0UL },                      /* CORE */
+    { rn2_on_display_rng, FALSE, { 0 }, 0UL },       /* DISP */
 };
 
+#ifdef RNGTRACE
+#ifndef RNGTRACE_SZ
+#define RNGTRACE_SZ 1024
+#endif
+
+/*
+ * The last RNGTRACE_SZ numbers drawn from either generator, each with
+ * the place in the source which asked for it.  The wrappers in extern.h
+ * call rng_caller() before rn2(), d(), and the rest, so a number drawn
+ * from within rnl() or d() is credited to rnl()'s or d()'s caller.
+ */
+static struct rngtrace {
+    const char *file;
+    int line;
+    int stream;          /* CORE or DISP */
+    unsigned long draw;  /* that stream's draw count */
+    int bound, result;
+} rngtrace[RNGTRACE_SZ];
+static unsigned rngtrace_next;
+static const char *rngtrace_file = "?";
+static int rngtrace_line;
+
+void
+rng_caller(const char *file, int line)
+{
+    rngtrace_file = file;
+    rngtrace_line = line;
+}
+
+static void
+rng_record(int stream, int bound, int result)
+{
+    struct rngtrace *rt = &rngtrace[rngtrace_next++ % RNGTRACE_SZ];
+
+    rt->file = rngtrace_file;
+    rt->line = rngtrace_line;
+    rt->stream = stream;
+    rt->draw = rnglist[stream].draws;
+    rt->bound = bound;
+    rt->result = result;
+}
+
+/* write out the recorded draws, oldest first */
+void
+dump_rngtrace(FILE *fp)
+{
+    unsigned i, n = min(rngtrace_next, RNGTRACE_SZ);
+    struct rngtrace *rt;
+
+    for (i = rngtrace_next - n; i != rngtrace_next; i++) {
+        rt = &rngtrace[i % RNGTRACE_SZ];
+        (void) fprintf(fp, "%s #%lu: %s:%d rn2(%d) = %d\n",
+                       (rt->stream == CORE) ? "core" : "disp", rt->draw,
+                       rt->file, rt->line, rt->bound, rt->result);
+    }
+}
+#endif /* RNGTRACE */
+
 int
 whichrng(int (*fn)(int))
 {
@@ -53,12 +124,121 @@ init_isaac64(unsigned long seed, int (*fn)(int))
     }
     isaac64_init(&rnglist[rngindx].rng_state, new_rng_state,
                  (int) sizeof seed);
+    rnglist[rngindx].draws = 0UL;
+}
+
+/* how many numbers the generator behind fn has produced since seeding */
+unsigned long
+rng_draws(int (*fn)(int))
+{
+    int rngindx = whichrng(fn);
+
+    return (rngindx >= 0) ? rnglist[rngindx].draws : 0UL;
+}
+
+/* copy the state of the generator behind fn, draw count included, to or
+   from a buffer of rng_state_size() bytes */
+size_t
+rng_state_size(void)
+{
+    return sizeof rnglist[0].rng_state + sizeof rnglist[0].draws;
+}
+
+void
+get_rngstate(int (*fn)(int), genericptr_t buf)
+{
+    int rngindx = whichrng(fn);
+    char *p = (char *) buf;
+
+    if (rngindx < 0)
+        panic("Bad rng function passed to get_rngstate().");
+    (void) memcpy((genericptr_t) p, (genericptr_t) &rnglist[rngindx].rng_state,
+                  sizeof rnglist[rngindx].rng_state);
+    p += sizeof rnglist[rngindx].rng_state;
+    (void) memcpy((genericptr_t) p, (genericptr_t) &rnglist[rngindx].draws,
+                  sizeof rnglist[rngindx].draws);
+}
+
+void
+set_rngstate(int (*fn)(int), genericptr_t buf)
+{
+    int rngindx = whichrng(fn);
+    char *p = (char *) buf;
+
+    if (rngindx < 0)
+        panic("Bad rng function passed to set_rngstate().");
+    (void) memcpy((genericptr_t) &rnglist[rngindx].rng_state,
+                  (genericptr_t) p, sizeof rnglist[rngindx].rng_state);
+    p += sizeof rnglist[rngindx].rng_state;
+    (void) memcpy((genericptr_t) &rnglist[rngindx].draws,
+                  (genericptr_t) p, sizeof rnglist[rngindx].draws);
+}
+
+/* next 64 bits of a stream; this is isaac64_next_uint64() done in line,
+   taking results from the current block of ISAAC64_SZ and only calling
+   out to have the next block generated once it's been used up */
+#define rng_next(ctx) \
+    ((ctx)->n ? (ctx)->r[--(ctx)->n] : isaac64_next_uint64(ctx))
+
+/*
+ * The RNG_FAST profile (flags.rng_profile) turns 64 random bits into a
+ * number below x by multiplying the upper 32 by x and keeping the top
+ * of the product, rather than by division.  The few products whose low
+ * half falls below (2^32 - x) % x are rejected to keep every outcome
+ * equally likely; that threshold is kept in a table for small bounds,
+ * so that only an unlikely rejection test on a big bound ever divides.
+ * Since it gives different numbers than the RNG_CLASSIC profile, the
+ * profile is part of flags and so stays with a saved game.
+ */
+#define RNGTHRESH_MAX 256
+static uint32_t rngthresh[RNGTHRESH_MAX + 1];
+static boolean rngthresh_set = FALSE;
+
+static void
+init_rngthresh(void)
+{
+    uint32_t x;
+
+    for (x = 1; x <= RNGTHRESH_MAX; x++)
+        rngthresh[x] = (uint32_t) (0U - x) % x;
+    rngthresh_set = TRUE;
+}
+
+static int
+rng_bounded(struct rnglist_t *rl, int x)
+{
+    uint32_t bound = (uint32_t) x, thresh;
+    uint64_t m = (rng_next(&rl->rng_state) >> 32) * bound;
+
+    rl->draws++;
+    if ((uint32_t) m < bound) {
+        if (!rngthresh_set)
+            init_rngthresh();
+        thresh = (bound <= RNGTHRESH_MAX) ? rngthresh[bound]
+                                           : (0U - bound) % bound;
+        while ((uint32_t) m < thresh) {
+            m = (rng_next(&rl->rng_state) >> 32) * bound;
+            rl->draws++;
+        }
+    }
+    return (int) (m >> 32);
 }
 
 static int
 RND(int x)
 {
-    return (isaac64_next_uint64(&rnglist[CORE].rng_state) % x);
+    int res;
+
+    if (flags.rng_profile == RNG_FAST) {
+        res = rng_bounded(&rnglist[CORE], x);
+    } else {
+        res = (int) (rng_next(&rnglist[CORE].rng_state) % x);
+        rnglist[CORE].draws++;
+    }
+#ifdef RNGTRACE
+    rng_record(CORE, x, res);
+#endif
+    return res;
 }
 
 /* 0 <= rn2(x) < x, but on a different sequence from the "main" rn2;
@@ -67,11 +247,61 @@ RND(int x)
 int
 rn2_on_display_rng(register int x)
 {
-    return (isaac64_next_uint64(&rnglist[DISP].rng_state) % x);
+    int res;
+
+    if (flags.rng_profile == RNG_FAST) {
+        res = rng_bounded(&rnglist[DISP], x);
+    } else {
+        res = (int) (rng_next(&rnglist[DISP].rng_state) % x);
+        rnglist[DISP].draws++;
+    }
+#ifdef RNGTRACE
+    rng_record(DISP, x, res);
+#endif
+    return res;
 }
 
 #else   /* USE_ISAAC64 */
 
+/* the system's generator can't be examined or counted */
+unsigned long
+rng_draws(int (*fn)(int) UNUSED)
+{
+    return 0UL;
+}
+
+size_t
+rng_state_size(void)
+{
+    return 0;
+}
+
+void
+get_rngstate(int (*fn)(int) UNUSED, genericptr_t buf UNUSED)
+{
+    return;
+}
+
+void
+set_rngstate(int (*fn)(int) UNUSED, genericptr_t buf UNUSED)
+{
+    return;
+}
+
+#ifdef RNGTRACE
+void
+rng_caller(const char *file UNUSED, int line UNUSED)
+{
+    return;
+}
+
+void
+dump_rngtrace(FILE *fp UNUSED)
+{
+    return;
+}
+#endif /* RNGTRACE */
+
 /* "Rand()"s definition is determined by [OS]conf.h */
 #if defined(LINT) && defined(UNIX) /* rand() is long... */
 extern int rand(void);
@@ -93,6 +323,45 @@ rn2_on_display_rng(register int x)
 }
 #endif  /* USE_ISAAC64 */
 
+/* write the generators' internal state, for a snapshot of the game;
+   without ISAAC64 the system's generator is used and its state can't
+   be captured, so nothing is written and nothing will be restored */
+void
+save_rngstate(NHFILE *nhfp)
+{
+#ifdef USE_ISAAC64
+    int i;
+
+    if (perform_bwrite(nhfp) && nhfp->structlevel)
+        for (i = 0; i < SIZE(rnglist); ++i) {
+            bwrite(nhfp->fd, (genericptr_t) &rnglist[i].rng_state,
+                   sizeof rnglist[i].rng_state);
+            bwrite(nhfp->fd, (genericptr_t) &rnglist[i].draws,
+                   sizeof rnglist[i].draws);
+        }
+#else
+    nhUse(nhfp);
+#endif
+}
+
+void
+rest_rngstate(NHFILE *nhfp)
+{
+#ifdef USE_ISAAC64
+    int i;
+
+    if (nhfp->structlevel)
+        for (i = 0; i < SIZE(rnglist); ++i) {
+            mread(nhfp->fd, (genericptr_t) &rnglist[i].rng_state,
+                  sizeof rnglist[i].rng_state);
+            mread(nhfp->fd, (genericptr_t) &rnglist[i].draws,
+                  sizeof rnglist[i].draws);
+        }
+#else
+    nhUse(nhfp);
+#endif
+}
+
 /* 0 <= rn2(x) < x */
 int
 rn2(register int x)
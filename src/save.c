@@ -155,6 +155,8 @@ dosave0(void)
     if (nhfp && nhfp->fplog)
         (void) fprintf(nhfp->fplog, "# post-validation\n");
     store_plname_in_file(nhfp);
+    if (nhfp->structlevel && (sfsaveinfo.sfi1 & SFI1_LZCOMP))
+        lzon(nhfp->fd, FALSE); /* the rest is compressed */
     g.ustuck_id = (u.ustuck ? u.ustuck->m_id : 0);
     g.usteed_id = (u.usteed ? u.usteed->m_id : 0);
     /* savelev() might save uball and uchain, releasing their memory if
@@ -400,6 +402,8 @@ savestateinlock(void)
         if (flags.ins_chkpt) {
             int currlev = ledger_no(&u.uz);
 
+            /* recover will want the levels kept in memory */
+            lstore_flush();
             if (nhfp->structlevel)
                 (void) write(nhfp->fd, (genericptr_t) &currlev, sizeof currlev);
             save_savefile_name(nhfp);
@@ -517,6 +521,8 @@ savelev(NHFILE* nhfp, xchar lev)
                 levl[x][y].seenv = 0;
                 levl[x][y].glyph = GLYPH_UNEXPLORED;
             }
+        (void) memset((genericptr_t) g.level.objbuckets, 0,
+                      sizeof g.level.objbuckets);
         fmon = 0;
         g.ftrap = 0;
         fobj = 0;
@@ -1018,18 +1024,72 @@ store_savefileinfo(NHFILE* nhfp)
      *
      * sfrestinfo (decl.c) describes the savefile info that is
      * being used to read the information from an existing savefile.
+     *
+     * Level files, including the lock file which recover copies
+     * into a save file along with them, aren't compressed.
      */
+    struct savefile_info sfi = sfsaveinfo;
 
+    if (nhfp->ftype == NHF_LEVELFILE)
+        sfi.sfi1 &= ~SFI1_LZCOMP;
     if (nhfp->structlevel) {
         bufoff(nhfp->fd);
         /* bwrite() before bufon() uses plain write() */
-        bwrite(nhfp->fd, (genericptr_t) &sfsaveinfo,
-               (unsigned) sizeof sfsaveinfo);
+        bwrite(nhfp->fd, (genericptr_t) &sfi, (unsigned) sizeof sfi);
         bufon(nhfp->fd);
     }
     return;
 }
 
+/* release the objects, monsters, and everything else that savelev() and
+   savegamestate() write for the current level and the game as a whole,
+   leaving things as they are before a save file is restored */
+void
+discard_gamestate(void)
+{
+    NHFILE tnhfp;
+    struct obj *bc_objs = (struct obj *) 0;
+
+    zero_nhfile(&tnhfp);    /* also sets fd to -1 */
+    tnhfp.mode = FREEING;
+
+    /* a ball and chain dangling inside an engulfer aren't on any list */
+    if (CHAIN_IN_MON) {
+        uchain->nobj = bc_objs;
+        bc_objs = uchain;
+    }
+    if (BALL_IN_MON) {
+        uball->nobj = bc_objs;
+        bc_objs = uball;
+    }
+
+    /* move-specific data */
+    dmonsfree(); /* release dead monsters */
+
+    /* level-specific data */
+    savelev(&tnhfp, -1);
+
+    /* game-state data */
+    save_killers(&tnhfp);
+    save_timers(&tnhfp, RANGE_GLOBAL);
+    save_light_sources(&tnhfp, RANGE_GLOBAL);
+    saveobjchn(&tnhfp, &g.invent);
+    saveobjchn(&tnhfp, &bc_objs);
+    saveobjchn(&tnhfp, &g.migrating_objs);
+    savemonchn(&tnhfp, g.migrating_mons), g.migrating_mons = 0;
+    savemonchn(&tnhfp, g.mydogs), g.mydogs = 0; /* ascension or escape */
+    mon_animal_list(FALSE);
+    save_oracles(&tnhfp);
+    savefruitchn(&tnhfp);
+    savenames(&tnhfp);
+    save_waterlevel(&tnhfp);
+    savelevchn(&tnhfp);
+    save_dungeon(&tnhfp, FALSE, TRUE);
+    /* level_align() remembers an entry in the special level chain */
+    g.rndmonst_cache.align_moves = 0L;
+    g.rndmonst_cache.align_lev = (s_level *) 0;
+}
+
 /* also called by prscore(); this probably belongs in dungeon.c... */
 void
 free_dungeons(void)
@@ -1049,52 +1109,30 @@ free_dungeons(void)
 void
 freedynamicdata(void)
 {
-    NHFILE tnhfp;
+#ifdef FREE_ALL_MEMORY
+    int ltmp;
+#endif
 
 #if defined(UNIX) && defined(MAIL)
     free_maildata();
 #endif
-    zero_nhfile(&tnhfp);    /* also sets fd to -1 */
-    tnhfp.mode = FREEING;
     free_menu_coloring();
     free_invbuf();           /* let_to_name (invent.c) */
     free_youbuf();           /* You_buf,&c (pline.c) */
     msgtype_free();
     tmp_at(DISP_FREEMEM, 0); /* temporary display effects */
 #ifdef FREE_ALL_MEMORY
-#define free_current_level() savelev(&tnhfp, -1)
-#define freeobjchn(X) (saveobjchn(&tnhfp, &X), X = 0)
-#define freemonchn(X) (savemonchn(&tnhfp, X), X = 0)
-#define freefruitchn() savefruitchn(&tnhfp)
-#define freenames() savenames(&tnhfp)
-#define free_killers() save_killers(&tnhfp)
-#define free_oracles() save_oracles(&tnhfp)
-#define free_waterlevel() save_waterlevel(&tnhfp)
-#define free_timers(R) save_timers(&tnhfp, R)
-#define free_light_sources(R) save_light_sources(&tnhfp, R)
-#define free_animals() mon_animal_list(FALSE)
-
-    /* move-specific data */
-    dmonsfree(); /* release dead monsters */
-
-    /* level-specific data */
-    free_current_level();
-
-    /* game-state data [ought to reorganize savegamestate() to handle this] */
-    free_killers();
-    free_timers(RANGE_GLOBAL);
-    free_light_sources(RANGE_GLOBAL);
-    freeobjchn(g.invent);
-    freeobjchn(g.migrating_objs);
-    freemonchn(g.migrating_mons);
-    freemonchn(g.mydogs); /* ascension or dungeon escape */
-    /* freelevchn();  --  [folded into free_dungeons()] */
-    free_animals();
-    free_oracles();
-    freefruitchn();
-    freenames();
-    free_waterlevel();
-    free_dungeons();
+    discard_gamestate();
+    free_dungeons(); /* what's left of them: the lua themes */
+    for (ltmp = 0; ltmp < MAXLINFO; ltmp++)
+        snaplevel_forget(ltmp);
+    nhl_core_done();
+    if (g.area_hits)
+        free((genericptr_t) g.area_hits), g.area_hits = 0;
+    g.area_hits_size = 0;
+    /* everything that came from them should be gone by now */
+    for (ltmp = 0; ltmp < NUM_NHPOOLS; ltmp++)
+        (void) nhpool_release(&nhpools[ltmp]);
 
     /* some pointers in iflags */
     if (iflags.wc_font_map)
@@ -1132,4 +1170,158 @@ freedynamicdata(void)
     return;
 }
 
+/*
+ * Snapshots.  snapshot_take() copies the whole game into memory without
+ * disturbing it, the way a save would write it out, and snapshot_restore()
+ * (restore.c) puts it back, so that a caller can try a line of play and
+ * then return to where it started as many times as it likes.
+ *
+ * The game state proper and the current level go into a buffer through
+ * the in-memory files of sfstruct.c.  The other levels are already on
+ * disk in their level files; a file is read once into g.snaplevels[] and
+ * every snapshot taken before it changes shares that copy, so taking a
+ * snapshot costs a read of only the levels left since the last one, and
+ * restoring one rewrites only the level files which differ from it.
+ * create_levelfile() and delete_levelfile() drop the cached copy.
+ */
+
+/* drop the cached copy of a level file, or a snapshot's hold on one */
+static void
+snaplevel_release(struct snaplevel *sl)
+{
+    if (sl && --sl->refcnt <= 0) {
+        free((genericptr_t) sl->data);
+        free((genericptr_t) sl);
+    }
+}
+
+void
+snaplevel_forget(int lev)
+{
+    if (lev >= 0 && lev < MAXLINFO && g.snaplevels[lev]) {
+        snaplevel_release(g.snaplevels[lev]);
+        g.snaplevels[lev] = (struct snaplevel *) 0;
+    }
+}
+
+/* the contents of a level file, read into the cache if not already there;
+   the caller gets a reference of its own */
+static struct snaplevel *
+snaplevel_get(xchar lev)
+{
+    struct snaplevel *sl = g.snaplevels[lev];
+    NHFILE *nhfp;
+    char whynot[BUFSZ], buf[BUFSZ * 8];
+    int fd, cnt;
+
+    if (!sl) {
+        nhfp = open_levelfile(lev, whynot);
+        if (!nhfp) {
+            impossible("%s", whynot);
+            return (struct snaplevel *) 0;
+        }
+        fd = memfile_create();
+        while ((cnt = nhread(nhfp->fd, buf, sizeof buf)) > 0)
+            bwrite(fd, (genericptr_t) buf, (unsigned) cnt);
+        close_nhfile(nhfp);
+        sl = (struct snaplevel *) alloc(sizeof *sl);
+        sl->refcnt = 1; /* the cache's */
+        sl->data = memfile_close(fd, &sl->len);
+        g.snaplevels[lev] = sl;
+    }
+    sl->refcnt++;
+    return sl;
+}
+
+/* put a level file back the way it was in a snapshot */
+void
+snaplevel_put(xchar lev, struct snaplevel *sl)
+{
+    NHFILE *nhfp;
+    char whynot[BUFSZ];
+
+    if (g.snaplevels[lev] == sl
+        && (g.level_info[lev].flags & LFILE_EXISTS) != 0)
+        return; /* unchanged since it was read or written */
+    nhfp = create_levelfile(lev, whynot); /* also forgets cached copy */
+    if (!nhfp)
+        panic("%s", whynot);
+    if (sl->len)
+        bwrite(nhfp->fd, (genericptr_t) sl->data, (unsigned) sl->len);
+    close_nhfile(nhfp);
+    sl->refcnt++;
+    g.snaplevels[lev] = sl;
+}
+
+struct snapshot *
+snapshot_take(void)
+{
+    struct snapshot *snap;
+    NHFILE nhf;
+    struct obj *piece = g.context.victual.piece, *tin = g.context.tin.tin,
+               *book = g.context.spbook.book;
+    struct monst *hitmon = g.context.polearm.hitmon;
+    xchar ltmp;
+
+    snap = (struct snapshot *) alloc(sizeof *snap);
+    (void) memset((genericptr_t) snap, 0, sizeof *snap);
+    snap->ledger = ledger_no(&u.uz);
+
+    zero_nhfile(&nhf);
+    nhf.structlevel = TRUE;
+    nhf.ftype = NHF_SAVEFILE;
+    nhf.mode = WRITING;
+    nhf.fd = memfile_create();
+
+    g.program_state.saving++;
+    /* a save leaves ids in place of the pointers into object and monster
+       chains as it frees those; nothing is freed here, so do it by hand */
+    if (piece)
+        g.context.victual.o_id = piece->o_id, g.context.victual.piece = 0;
+    if (tin)
+        g.context.tin.o_id = tin->o_id, g.context.tin.tin = 0;
+    if (book)
+        g.context.spbook.o_id = book->o_id, g.context.spbook.book = 0;
+    if (hitmon)
+        g.context.polearm.m_id = hitmon->m_id, g.context.polearm.hitmon = 0;
+    g.ustuck_id = (u.ustuck ? u.ustuck->m_id : 0);
+    g.usteed_id = (u.usteed ? u.usteed->m_id : 0);
+    g.looseball = BALL_IN_MON ? uball : 0;
+    g.loosechain = CHAIN_IN_MON ? uchain : 0;
+    /* savelev() would set this, but after level_info[] has been written */
+    g.level_info[snap->ledger].flags |= VISITED;
+
+    /* the reverse of a save file's order, so that restoring the game state
+       first lets the current level's objects be matched with context */
+    savegamestate(&nhf);
+    savelev(&nhf, snap->ledger);
+    save_rngstate(&nhf);
+
+    g.context.victual.piece = piece;
+    g.context.tin.tin = tin;
+    g.context.spbook.book = book;
+    g.context.polearm.hitmon = hitmon;
+    g.program_state.saving--;
+    snap->state = memfile_close(nhf.fd, &snap->statelen);
+
+    for (ltmp = 1; ltmp <= maxledgerno(); ltmp++)
+        if (ltmp != snap->ledger
+            && (g.level_info[ltmp].flags & LFILE_EXISTS) != 0)
+            snap->levels[ltmp] = snaplevel_get(ltmp);
+    return snap;
+}
+
+void
+snapshot_free(struct snapshot *snap)
+{
+    int ltmp;
+
+    if (!snap)
+        return;
+    for (ltmp = 0; ltmp < MAXLINFO; ltmp++)
+        snaplevel_release(snap->levels[ltmp]);
+    free((genericptr_t) snap->state);
+    free((genericptr_t) snap);
+}
+
 /*save.c*/
@@ -4,6 +4,10 @@
 /* NetHack may be freely redistributed.  See license for details. */
 
 #include "hack.h"
+#ifdef USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 /*
  * historical structlevel savefile writing and reading routines follow.
@@ -41,7 +45,22 @@ void mread(int, genericptr_t, unsigned int);
 void minit(void);
 void bclose(int);
 #endif /* TRACE_BUFFERING */
+struct lzstream;
+
 static int getidx(int, int);
+static void bwrite_raw(int, genericptr_t, unsigned int);
+static struct lzstream *lzstream_of(int);
+static void lz_slide(struct lzstream *);
+static boolean lz_emit(uchar **, uchar *, uchar *, unsigned,
+                       unsigned, unsigned);
+static unsigned lz_encode(struct lzstream *);
+static boolean lz_decode(struct lzstream *, uchar *, unsigned,
+                         unsigned);
+static void lz_putle(uchar *, unsigned long, int);
+static unsigned long lz_getle(uchar *, int);
+static void lz_flushblock(struct lzstream *);
+static void lz_write(struct lzstream *, genericptr_t, unsigned);
+static int lz_read(struct lzstream *, genericptr_t, unsigned);
 
 #if defined(UNIX) || defined(WIN32)
 #define USE_BUFFERING
@@ -59,6 +78,229 @@ static int bw_buffered[MAXFD] = {0,0,0,0,0};
 static FILE *bw_FILE[MAXFD] = {0,0,0,0,0};
 #endif
 
+/*
+ * In-memory files.  Descriptors from MEMFD_BASE up don't refer to an
+ * open file but to a buffer, which lets bwrite() and mread() -- and so
+ * everything in save.c and restore.c built on them -- be pointed at
+ * memory.  One opened by memfile_create() is written to and grows as
+ * needed; one opened by memfile_open() reads from a caller's buffer, and
+ * memfile_map() turns a descriptor for a file being read into one that
+ * reads from a mapping of the whole file.  Buffering doesn't apply to
+ * them, so bufon(), bufoff() and bflush() ignore them.  Code which reads
+ * with read() rather than mread() uses nhread() to cover them too.
+ */
+#define MEMFD_BASE 0x4000
+#define MAXMEMFD 4
+
+static struct memfile {
+    char *buf;
+    size_t len;     /* bytes written so far, or available to read */
+    size_t size;    /* bytes allocated (0 for a read-only buffer) */
+    size_t pos;     /* next byte to read */
+    boolean inuse;
+    boolean mapped; /* buf is a mapping made by memfile_map() */
+} memfiles[MAXMEMFD];
+
+static struct memfile *
+memfile_of(int fd)
+{
+    if (fd < MEMFD_BASE || fd >= MEMFD_BASE + MAXMEMFD
+        || !memfiles[fd - MEMFD_BASE].inuse)
+        return (struct memfile *) 0;
+    return &memfiles[fd - MEMFD_BASE];
+}
+
+static int
+memfile_slot(void)
+{
+    int i;
+
+    for (i = 0; i < MAXMEMFD; ++i)
+        if (!memfiles[i].inuse) {
+            (void) memset((genericptr_t) &memfiles[i], 0,
+                          sizeof memfiles[i]);
+            memfiles[i].inuse = TRUE;
+            return i;
+        }
+    panic("out of in-memory file slots");
+    /*NOTREACHED*/
+    return -1;
+}
+
+/* open an empty in-memory file for writing */
+int
+memfile_create(void)
+{
+    return MEMFD_BASE + memfile_slot();
+}
+
+/* open an in-memory file that reads from buf[0..len-1]; the buffer is
+   not copied, so it has to stay put until memfile_close() */
+int
+memfile_open(const char *buf, size_t len)
+{
+    int i = memfile_slot();
+
+    memfiles[i].buf = (char *) buf;
+    memfiles[i].len = len;
+    return MEMFD_BASE + i;
+}
+
+/* switch a file open for reading over to an in-memory one that reads
+   from a mapping of the file, starting at the same offset; returns the
+   new descriptor, or the old one if the file couldn't be mapped */
+int
+memfile_map(int fd)
+{
+#ifdef USE_MMAP
+    struct stat st;
+    off_t pos;
+    genericptr_t map;
+    int i;
+
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0
+        || (pos = lseek(fd, (off_t) 0, SEEK_CUR)) < 0)
+        return fd;
+    map = mmap((genericptr_t) 0, (size_t) st.st_size, PROT_READ,
+               MAP_PRIVATE, fd, (off_t) 0);
+    if (map == MAP_FAILED)
+        return fd;
+#ifdef MADV_SEQUENTIAL
+    (void) madvise(map, (size_t) st.st_size, MADV_SEQUENTIAL);
+#endif
+    i = memfile_slot();
+    memfiles[i].buf = (char *) map;
+    memfiles[i].len = (size_t) st.st_size;
+    memfiles[i].pos = (size_t) pos;
+    memfiles[i].mapped = TRUE;
+    (void) close(fd);
+    return MEMFD_BASE + i;
+#else
+    return fd;
+#endif
+}
+
+/* back to the start of an in-memory file; FALSE if fd isn't one */
+boolean
+memfile_rewind(int fd)
+{
+    struct memfile *mf = memfile_of(fd);
+
+    if (!mf)
+        return FALSE;
+    mf->pos = 0;
+    return TRUE;
+}
+
+/* read() which also handles in-memory files */
+int
+nhread(int fd, genericptr_t buf, unsigned len)
+{
+    struct memfile *mf = memfile_of(fd);
+    size_t cnt;
+
+    if (!mf)
+        return (int) read(fd, buf, len);
+    cnt = min((size_t) len, mf->len - mf->pos);
+    (void) memcpy(buf, (genericptr_t) (mf->buf + mf->pos), cnt);
+    mf->pos += cnt;
+    return (int) cnt;
+}
+
+/* close an in-memory file; for one opened by memfile_create(), hand the
+   data that was written to it over to the caller (who frees it) if
+   lenp is non-null, otherwise discard it */
+char *
+memfile_close(int fd, size_t *lenp)
+{
+    struct memfile *mf = memfile_of(fd);
+    char *buf;
+
+    if (!mf) {
+        impossible("memfile_close: not an in-memory file (%d)?", fd);
+        return (char *) 0;
+    }
+    buf = mf->buf;
+    if (mf->mapped) {
+#ifdef USE_MMAP
+        (void) munmap((genericptr_t) buf, mf->len);
+#endif
+        buf = (char *) 0;
+        if (lenp)
+            *lenp = 0;
+    } else if (mf->size) {
+        if (lenp) {
+            *lenp = mf->len;
+        } else {
+            free((genericptr_t) buf);
+            buf = (char *) 0;
+        }
+    } else if (lenp) {
+        *lenp = mf->len;
+    }
+    (void) memset((genericptr_t) mf, 0, sizeof *mf);
+    return buf;
+}
+
+static void
+memfile_write(struct memfile *mf, genericptr_t loc, unsigned num)
+{
+    if (!mf->size && mf->buf)
+        panic("writing to a read-only in-memory file");
+    if (mf->len + num > mf->size) {
+        size_t newsize = mf->size ? mf->size : BUFSZ * 16;
+        char *newbuf;
+
+        while (newsize < mf->len + num)
+            newsize *= 2;
+        newbuf = (char *) alloc(newsize);
+        if (mf->len)
+            (void) memcpy((genericptr_t) newbuf, (genericptr_t) mf->buf,
+                          mf->len);
+        if (mf->buf)
+            free((genericptr_t) mf->buf);
+        mf->buf = newbuf;
+        mf->size = newsize;
+    }
+    (void) memcpy((genericptr_t) (mf->buf + mf->len), loc, num);
+    mf->len += num;
+}
+
+/*
+ * Built-in compression.  After lzon(), what bwrite() is given for a
+ * descriptor, or what mread() returns from it, goes through an LZ77
+ * coder a block of up to LZBLOCK bytes at a time.  Each block is
+ * stored as an LZHDRSIZE byte header followed by the data: a flags
+ * byte (LZF_CODED unless coding didn't shrink the block and its bytes
+ * are stored as-is), the block's length in the next three bytes and
+ * the length of the data after the header in the last four, both
+ * least significant byte first so that files move between machines.
+ * The most recent LZBLOCK bytes of earlier blocks stay around for
+ * matches to refer back to, so the records that make up a save file
+ * are found again across block boundaries.  The format is the same on
+ * the way in and the way out, so a descriptor being written and one
+ * being read share the bookkeeping.
+ */
+#define LZBLOCK 0x10000U
+#define LZHASHBITS 14
+#define LZMINMATCH 4
+#define LZMAXOFF 0xffffU
+#define LZHDRSIZE 8
+#define LZF_CODED 0x01
+
+static struct lzstream {
+    int fd;
+    boolean inuse;
+    boolean reading;
+    uchar *win;     /* 2 * LZBLOCK: history, then the current block */
+    uchar *out;     /* a coded block */
+    int *hash;      /* when writing: positions in win, by hash */
+    unsigned histlen; /* bytes of history just before win[LZBLOCK] */
+    unsigned len;   /* bytes in the current block */
+    unsigned pos;   /* when reading: next byte of the current block */
+} lzstreams[MAXFD];
+static int lz_active; /* number of lzstreams[] in use */
+
 /*
  * Presumably, the fdopen() to allow use of stdio fwrite()
  * over write() was done for performance or functionality
@@ -123,7 +365,7 @@ close_check(int fd)
     int idx = getidx(fd, NOSLOT);
     boolean retval = FALSE;
 
-    if (idx >= 0)
+    if (idx >= 0 || memfile_of(fd))
         retval = TRUE;
     return retval;
 }
@@ -131,8 +373,11 @@ close_check(int fd)
 void
 bufon(int fd)
 {
-    int idx = getidx(fd, NOFLG);
+    int idx;
 
+    if (memfile_of(fd))
+        return;
+    idx = getidx(fd, NOFLG);
     if (idx >= 0) {
         bw_sticky[idx] = fd;
 #ifdef USE_BUFFERING
@@ -152,8 +397,11 @@ bufon(int fd)
 void
 bufoff(int fd)
 {
-    int idx = getidx(fd, NOFLG);
+    int idx;
 
+    if (memfile_of(fd))
+        return;
+    idx = getidx(fd, NOFLG);
     if (idx >= 0) {
         bflush(fd);
         bw_buffered[idx] = 0;     /* just a flag that says "use write(fd)" */
@@ -163,8 +411,14 @@ bufoff(int fd)
 void
 bclose(int fd)
 {
-    int idx = getidx(fd, NOSLOT);
+    int idx;
 
+    lzoff(fd);
+    if (memfile_of(fd)) {
+        (void) memfile_close(fd, (size_t *) 0);
+        return;
+    }
+    idx = getidx(fd, NOSLOT);
     bufoff(fd);     /* sets bw_buffered[idx] = 0 */
     if (idx >= 0) {
 #ifdef USE_BUFFERING
@@ -183,8 +437,14 @@ bclose(int fd)
 void
 bflush(int fd)
 {
-    int idx = getidx(fd, NOFLG);
-
+    struct lzstream *lz = lzstream_of(fd);
+    int idx;
+
+    if (lz && !lz->reading)
+        lz_flushblock(lz);
+    if (memfile_of(fd))
+        return;
+    idx = getidx(fd, NOFLG);
     if (idx >= 0) {
 #ifdef USE_BUFFERING
         if (bw_FILE[idx]) {
@@ -198,10 +458,28 @@ bflush(int fd)
 
 void
 bwrite(register int fd, register genericptr_t loc, register unsigned num)
+{
+    struct lzstream *lz = lzstream_of(fd);
+
+    if (lz)
+        lz_write(lz, loc, num);
+    else
+        bwrite_raw(fd, loc, num);
+}
+
+/* bwrite() without compression */
+static void
+bwrite_raw(int fd, genericptr_t loc, unsigned num)
 {
     boolean failed;
-    int idx = getidx(fd, NOFLG);
+    struct memfile *mf = memfile_of(fd);
+    int idx;
 
+    if (mf) {
+        memfile_write(mf, loc, num);
+        return;
+    }
+    idx = getidx(fd, NOFLG);
     if (idx >= 0) {
 #ifdef USE_BUFFERING
         if (bw_buffered[idx] && bw_FILE[idx]) {
@@ -240,13 +518,20 @@ void
 mread(register int fd, register genericptr_t buf, register unsigned int len)
 {
     register int rlen;
+    struct memfile *mf = memfile_of(fd);
+    struct lzstream *lz = lzstream_of(fd);
 #if defined(BSD) || defined(ULTRIX)
 #define readLenType int
 #else /* e.g. SYSV, __TURBOC__ */
 #define readLenType unsigned
 #endif
 
-    rlen = read(fd, buf, (readLenType) len);
+    if (lz)
+        rlen = lz_read(lz, buf, len);
+    else if (mf)
+        rlen = nhread(fd, buf, len);
+    else
+        rlen = read(fd, buf, (readLenType) len);
     if ((readLenType) rlen != (readLenType) len) {
         if (restoreinfo.mread_flags == 1) { /* means "return anyway" */
             restoreinfo.mread_flags = -1;
@@ -263,6 +548,320 @@ mread(register int fd, register genericptr_t buf, register unsigned int len)
     }
 }
 
+/*  ===================================================== */
+
+static struct lzstream *
+lzstream_of(int fd)
+{
+    int i;
+
+    if (!lz_active)
+        return (struct lzstream *) 0;
+    for (i = 0; i < MAXFD; ++i)
+        if (lzstreams[i].inuse && lzstreams[i].fd == fd)
+            return &lzstreams[i];
+    return (struct lzstream *) 0;
+}
+
+/* start compressing what's written to fd, or decompressing what's read
+   from it, from its current position on */
+void
+lzon(int fd, boolean reading)
+{
+    struct lzstream *lz;
+    int i;
+
+    if (lzstream_of(fd))
+        panic("compression already enabled");
+    for (i = 0; i < MAXFD; ++i)
+        if (!lzstreams[i].inuse)
+            break;
+    if (i == MAXFD)
+        panic("out of compression slots");
+    lz = &lzstreams[i];
+    (void) memset((genericptr_t) lz, 0, sizeof *lz);
+    lz->fd = fd;
+    lz->inuse = TRUE;
+    lz->reading = reading;
+    lz->win = (uchar *) alloc(2 * LZBLOCK);
+    lz->out = (uchar *) alloc(LZBLOCK);
+    if (!reading) {
+        lz->hash = (int *) alloc((1 << LZHASHBITS) * sizeof (int));
+        for (i = 0; i < (1 << LZHASHBITS); ++i)
+            lz->hash[i] = -1;
+    }
+    ++lz_active;
+}
+
+/* finish the compressed part of fd; anything still to be written goes
+   out first, anything not yet read is dropped */
+void
+lzoff(int fd)
+{
+    struct lzstream *lz = lzstream_of(fd);
+
+    if (!lz)
+        return;
+    if (!lz->reading)
+        lz_flushblock(lz);
+    free((genericptr_t) lz->win);
+    free((genericptr_t) lz->out);
+    if (lz->hash)
+        free((genericptr_t) lz->hash);
+    (void) memset((genericptr_t) lz, 0, sizeof *lz);
+    --lz_active;
+}
+
+/* the current block becomes history; keep the last LZBLOCK bytes */
+static void
+lz_slide(struct lzstream *lz)
+{
+    unsigned keep = min(lz->histlen + lz->len, LZBLOCK);
+    int i, lowest = (int) (LZBLOCK - keep);
+
+    (void) memmove((genericptr_t) (lz->win + lowest),
+                   (genericptr_t) (lz->win + LZBLOCK + lz->len - keep),
+                   keep);
+    if (lz->hash)
+        for (i = 0; i < (1 << LZHASHBITS); ++i)
+            if (lz->hash[i] >= 0) {
+                lz->hash[i] -= (int) lz->len;
+                if (lz->hash[i] < lowest)
+                    lz->hash[i] = -1;
+            }
+    lz->histlen = keep;
+    lz->len = lz->pos = 0;
+}
+
+/*
+ * Each sequence is a token byte holding a literal count in its high
+ * nibble and a match length less LZMINMATCH in its low one (15 in
+ * either means further bytes, each 255 until the last, add to it),
+ * then the literals, then a two byte match offset.  The last sequence
+ * of a block has literals only.
+ */
+static boolean
+lz_emit(
+    uchar **opp, uchar *oend,
+    uchar *lit, unsigned litlen,
+    unsigned off, unsigned mlen)
+{
+    uchar *op = *opp, *token;
+    unsigned n;
+
+    if ((unsigned) (oend - op) < 1 + litlen / 255 + 1 + litlen + 2
+                                 + mlen / 255 + 1)
+        return FALSE;
+    token = op++;
+    *token = (uchar) (min(litlen, 15) << 4);
+    if (litlen >= 15) {
+        for (n = litlen - 15; n >= 255; n -= 255)
+            *op++ = 255;
+        *op++ = (uchar) n;
+    }
+    (void) memcpy((genericptr_t) op, (genericptr_t) lit, litlen);
+    op += litlen;
+    if (mlen) {
+        *op++ = (uchar) (off & 0xff);
+        *op++ = (uchar) (off >> 8);
+        n = mlen - LZMINMATCH;
+        *token |= (uchar) min(n, 15);
+        if (n >= 15) {
+            for (n -= 15; n >= 255; n -= 255)
+                *op++ = 255;
+            *op++ = (uchar) n;
+        }
+    }
+    *opp = op;
+    return TRUE;
+}
+
+#define lz_hash(p) \
+    ((unsigned) ((((unsigned long) (p)[0] | ((unsigned long) (p)[1] << 8) \
+                   | ((unsigned long) (p)[2] << 16)                       \
+                   | ((unsigned long) (p)[3] << 24)) * 2654435761UL)      \
+                 & 0xffffffffUL) >> (32 - LZHASHBITS))
+
+/* code the current block into lz->out; returns the coded length, or 0
+   if that wouldn't be shorter than the block itself */
+static unsigned
+lz_encode(struct lzstream *lz)
+{
+    uchar *ip = lz->win + LZBLOCK, *anchor = ip, *end = ip + lz->len,
+          *lowest = ip - lz->histlen, *ref, *op = lz->out,
+          *oend = op + lz->len;
+    unsigned h, mlen;
+    int cand;
+
+    while (end - ip >= LZMINMATCH) {
+        h = lz_hash(ip);
+        cand = lz->hash[h];
+        lz->hash[h] = (int) (ip - lz->win);
+        if (cand < 0 || (ref = lz->win + cand) < lowest
+            || (unsigned) (ip - ref) > LZMAXOFF
+            || memcmp((genericptr_t) ref, (genericptr_t) ip, LZMINMATCH)) {
+            ++ip;
+            continue;
+        }
+        for (mlen = LZMINMATCH; ip + mlen < end && ref[mlen] == ip[mlen];
+             ++mlen)
+            continue;
+        if (!lz_emit(&op, oend, anchor, (unsigned) (ip - anchor),
+                     (unsigned) (ip - ref), mlen))
+            return 0;
+        ip += mlen;
+        anchor = ip;
+    }
+    if (!lz_emit(&op, oend, anchor, (unsigned) (end - anchor), 0, 0))
+        return 0;
+    return (unsigned) (op - lz->out);
+}
+
+/* decode clen bytes into a current block of rawlen bytes */
+static boolean
+lz_decode(struct lzstream *lz, uchar *ip, unsigned clen,
+          unsigned rawlen)
+{
+    uchar *iend = ip + clen, *op = lz->win + LZBLOCK, *oend = op + rawlen,
+          *lowest = op - lz->histlen, *ref;
+    unsigned n, off, token, c;
+
+    while (ip < iend) {
+        token = *ip++;
+        if ((n = token >> 4) == 15)
+            do {
+                if (ip >= iend)
+                    return FALSE;
+                n += (c = *ip++);
+            } while (c == 255);
+        if (n > (unsigned) (iend - ip) || n > (unsigned) (oend - op))
+            return FALSE;
+        (void) memcpy((genericptr_t) op, (genericptr_t) ip, n);
+        op += n, ip += n;
+        if (ip == iend)
+            break;
+        if (iend - ip < 2)
+            return FALSE;
+        off = (unsigned) ip[0] | ((unsigned) ip[1] << 8);
+        ip += 2;
+        if ((n = token & 15) == 15)
+            do {
+                if (ip >= iend)
+                    return FALSE;
+                n += (c = *ip++);
+            } while (c == 255);
+        n += LZMINMATCH;
+        if (!off || off > (unsigned) (op - lowest)
+            || n > (unsigned) (oend - op))
+            return FALSE;
+        ref = op - off;
+        if (off >= n) {
+            (void) memcpy((genericptr_t) op, (genericptr_t) ref, n);
+            op += n;
+        } else {
+            while (n--) /* overlapping: a repeating pattern */
+                *op++ = *ref++;
+        }
+    }
+    return (boolean) (op == oend);
+}
+
+static void
+lz_putle(uchar *p, unsigned long val, int n)
+{
+    while (n--) {
+        *p++ = (uchar) (val & 0xff);
+        val >>= 8;
+    }
+}
+
+static unsigned long
+lz_getle(uchar *p, int n)
+{
+    unsigned long val = 0UL;
+
+    while (n--)
+        val = (val << 8) | p[n];
+    return val;
+}
+
+static void
+lz_flushblock(struct lzstream *lz)
+{
+    uchar hdr[LZHDRSIZE];
+    unsigned clen;
+
+    if (!lz->len)
+        return;
+    clen = lz_encode(lz);
+    hdr[0] = clen ? LZF_CODED : 0;
+    lz_putle(&hdr[1], (unsigned long) lz->len, 3);
+    lz_putle(&hdr[4], (unsigned long) (clen ? clen : lz->len), 4);
+    bwrite_raw(lz->fd, (genericptr_t) hdr, sizeof hdr);
+    if (clen)
+        bwrite_raw(lz->fd, (genericptr_t) lz->out, clen);
+    else
+        bwrite_raw(lz->fd, (genericptr_t) (lz->win + LZBLOCK), lz->len);
+    lz_slide(lz);
+}
+
+static void
+lz_write(struct lzstream *lz, genericptr_t loc, unsigned num)
+{
+    uchar *src = (uchar *) loc;
+    unsigned cnt;
+
+    while (num) {
+        cnt = min(num, LZBLOCK - lz->len);
+        (void) memcpy((genericptr_t) (lz->win + LZBLOCK + lz->len),
+                      (genericptr_t) src, cnt);
+        lz->len += cnt, src += cnt, num -= cnt;
+        if (lz->len == LZBLOCK)
+            lz_flushblock(lz);
+    }
+}
+
+/* read up to len bytes, fewer at the end of the data or if the next
+   block turns out to be damaged */
+static int
+lz_read(struct lzstream *lz, genericptr_t buf, unsigned len)
+{
+    uchar *dst = (uchar *) buf;
+    uchar hdr[LZHDRSIZE];
+    unsigned rawlen, clen, cnt, got = 0;
+
+    while (got < len) {
+        if (lz->pos == lz->len) {
+            lz_slide(lz);
+            if (nhread(lz->fd, (genericptr_t) hdr, sizeof hdr)
+                    != (int) sizeof hdr
+                || (hdr[0] & ~LZF_CODED) != 0)
+                break;
+            rawlen = (unsigned) lz_getle(&hdr[1], 3);
+            clen = (unsigned) lz_getle(&hdr[4], 4);
+            if (!rawlen || rawlen > LZBLOCK)
+                break;
+            if (!(hdr[0] & LZF_CODED)) {
+                if (clen != rawlen
+                    || nhread(lz->fd, (genericptr_t) (lz->win + LZBLOCK),
+                              rawlen) != (int) rawlen)
+                    break;
+            } else if (!clen || clen >= rawlen
+                       || nhread(lz->fd, (genericptr_t) lz->out, clen)
+                              != (int) clen
+                       || !lz_decode(lz, lz->out, clen, rawlen)) {
+                break;
+            }
+            lz->len = rawlen;
+        }
+        cnt = min(len - got, lz->len - lz->pos);
+        (void) memcpy((genericptr_t) (dst + got),
+                      (genericptr_t) (lz->win + LZBLOCK + lz->pos), cnt);
+        lz->pos += cnt, got += cnt;
+    }
+    return (int) got;
+}
+
 #ifdef TRACE_BUFFERING
 
 static FILE *tracefile;
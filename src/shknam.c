@@ -555,7 +555,7 @@ neweshk(struct monst* mtmp)
     if (!mtmp->mextra)
         mtmp->mextra = newmextra();
     if (!ESHK(mtmp))
-        ESHK(mtmp) = (struct eshk *) alloc(sizeof(struct eshk));
+        ESHK(mtmp) = (struct eshk *) pool_get(POOL_ESHK);
     (void) memset((genericptr_t) ESHK(mtmp), 0, sizeof(struct eshk));
     ESHK(mtmp)->bill_p = (struct bill_x *) 0;
 }
@@ -564,7 +564,7 @@ void
 free_eshk(struct monst* mtmp)
 {
     if (mtmp->mextra && ESHK(mtmp)) {
-        free((genericptr_t) ESHK(mtmp));
+        pool_put(POOL_ESHK, ESHK(mtmp));
         ESHK(mtmp) = (struct eshk *) 0;
     }
     mtmp->isshk = 0;
@@ -99,7 +99,6 @@ static int get_table_region(lua_State *, const char *, int *, int *, int *,
 static void set_wallprop_in_selection(lua_State *, int);
 static int floodfillchk_match_under(int, int);
 static int floodfillchk_match_accessible(int, int);
-static boolean sel_flood_havepoint(int, int, xchar *, xchar *, int);
 static long line_dist_coord(long, long, long, long, long, long);
 static void l_push_wid_hei_table(lua_State *, int, int);
 static int get_table_align(lua_State *);
@@ -767,6 +766,9 @@ flip_level(int flp, boolean extras)
 	    }
     }
 
+    /* objects were moved between spots without place_object() */
+    recalc_obj_buckets();
+
     /* timed effects */
     for (timer = g.timer_base; timer; timer = timer->next) {
         if (timer->func_index == MELT_ICE_AWAY) {
@@ -778,6 +780,7 @@ flip_level(int flp, boolean extras)
             if (flp & 2)
                 tx = FlipX(tx);
             timer->arg.a_long = ((tx << 16) | ty);
+            rehash_timer(timer);
         }
     }
 
@@ -4152,6 +4155,51 @@ lspo_random_corridors(lua_State* L UNUSED)
 }
 
 /* selection */
+
+/*
+ * A selection is a bitmap with one word per map column; bit y of
+ * map[x] is set when <x,y> is selected.  Keeping columns in words,
+ * rather than rows, means that visiting the set bits word by word goes
+ * through the points in the same x-major, y-minor order as the nested
+ * loops that things like selection_rndcoord() used to use, so random
+ * numbers are drawn for the same points in the same order as before.
+ */
+#if ROWNO > 32
+#error selectionvar needs a wider column word for ROWNO > 32
+#endif
+
+#define SEL_COLMASK(sel) ((1UL << (sel)->hei) - 1UL)
+
+/* number of set bits in a column word */
+static int
+sel_popcount(unsigned long w)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountl(w);
+#else
+    int n;
+
+    for (n = 0; w; ++n)
+        w &= w - 1UL; /* clear lowest set bit */
+    return n;
+#endif
+}
+
+/* row number of the lowest set bit of a non-zero column word */
+static int
+sel_lowbit(unsigned long w)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzl(w);
+#else
+    int y = 0;
+
+    while (!(w & 1UL))
+        w >>= 1, ++y;
+    return y;
+#endif
+}
+
 struct selectionvar *
 selection_new(void)
 {
@@ -4159,9 +4207,8 @@ selection_new(void)
 
     tmps->wid = COLNO;
     tmps->hei = ROWNO;
-    tmps->map = (char *) alloc((COLNO * ROWNO) + 1);
-    (void) memset(tmps->map, 1, (COLNO * ROWNO));
-    tmps->map[(COLNO * ROWNO)] = '\0';
+    tmps->map = (unsigned long *) alloc(COLNO * sizeof (unsigned long));
+    (void) memset((genericptr_t) tmps->map, 0, COLNO * sizeof (unsigned long));
 
     return tmps;
 }
@@ -4179,15 +4226,28 @@ selection_free(struct selectionvar* sel, boolean freesel)
     }
 }
 
+/* make 'dst' hold the same points as 'src' */
+void
+selection_copy(struct selectionvar *dst, struct selectionvar *src)
+{
+    if (!dst->map || dst->wid != src->wid) {
+        Free(dst->map);
+        dst->map = (unsigned long *) alloc(src->wid * sizeof (unsigned long));
+    }
+    dst->wid = src->wid;
+    dst->hei = src->hei;
+    (void) memcpy((genericptr_t) dst->map, (genericptr_t) src->map,
+                  src->wid * sizeof (unsigned long));
+}
+
 struct selectionvar *
 selection_clone(struct selectionvar* sel)
 {
     struct selectionvar *
         tmps = (struct selectionvar *) alloc(sizeof (struct selectionvar));
 
-    tmps->wid = sel->wid;
-    tmps->hei = sel->hei;
-    tmps->map = dupstr(sel->map);
+    tmps->map = NULL;
+    selection_copy(tmps, sel);
 
     return tmps;
 }
@@ -4200,7 +4260,7 @@ selection_getpoint(int x, int y, struct selectionvar* sel)
     if (x < 0 || y < 0 || x >= sel->wid || y >= sel->hei)
         return 0;
 
-    return (sel->map[sel->wid * y + x] - 1);
+    return (xchar) ((sel->map[x] >> y) & 1UL);
 }
 
 void
@@ -4211,34 +4271,105 @@ selection_setpoint(int x, int y, struct selectionvar* sel, xchar c)
     if (x < 0 || y < 0 || x >= sel->wid || y >= sel->hei)
         return;
 
-    sel->map[sel->wid * y + x] = (char) (c + 1);
+    if (c)
+        sel->map[x] |= (1UL << y);
+    else
+        sel->map[x] &= ~(1UL << y);
 }
 
 struct selectionvar *
 selection_not(struct selectionvar* s)
 {
-    int x, y;
-
+    int x;
+    unsigned long mask = SEL_COLMASK(s);
 
     for (x = 0; x < s->wid; x++)
-        for (y = 0; y < s->hei; y++)
-            selection_setpoint(x, y, s, selection_getpoint(x, y, s) ? 0 : 1);
+        s->map[x] = ~s->map[x] & mask;
 
     return s;
 }
 
+/* ret = s1 & s2, ret = s1 | s2, or ret = s1 ^ s2; ret may be s1 or s2 */
+void
+selection_and(struct selectionvar *ret, struct selectionvar *s1,
+              struct selectionvar *s2)
+{
+    int x;
+
+    for (x = 0; x < ret->wid; x++)
+        ret->map[x] = s1->map[x] & s2->map[x];
+}
+
+void
+selection_or(struct selectionvar *ret, struct selectionvar *s1,
+             struct selectionvar *s2)
+{
+    int x;
+
+    for (x = 0; x < ret->wid; x++)
+        ret->map[x] = s1->map[x] | s2->map[x];
+}
+
+void
+selection_xor(struct selectionvar *ret, struct selectionvar *s1,
+              struct selectionvar *s2)
+{
+    int x;
+
+    for (x = 0; x < ret->wid; x++)
+        ret->map[x] = s1->map[x] ^ s2->map[x];
+}
+
+/* number of points in the selection */
+int
+selection_numpoints(struct selectionvar *ov)
+{
+    int x, n = 0;
+
+    if (!ov || !ov->map)
+        return 0;
+    for (x = 0; x < ov->wid; x++)
+        n += sel_popcount(ov->map[x]);
+    return n;
+}
+
+/* find the n'th (counting from 0) set point, in x-major order */
+boolean
+selection_nthpoint(struct selectionvar *ov, int n, xchar *x, xchar *y)
+{
+    int dx, cnt;
+    unsigned long w;
+
+    if (ov && ov->map && n >= 0)
+        for (dx = 0; dx < ov->wid; dx++) {
+            w = ov->map[dx];
+            if ((cnt = sel_popcount(w)) <= n) {
+                n -= cnt;
+                continue;
+            }
+            while (n-- > 0)
+                w &= w - 1UL;
+            *x = (xchar) dx;
+            *y = (xchar) sel_lowbit(w);
+            return TRUE;
+        }
+    return FALSE;
+}
+
 struct selectionvar *
 selection_filter_mapchar(struct selectionvar* ov,  xchar typ, int lit)
 {
     int x, y;
+    unsigned long w;
     struct selectionvar *ret = selection_new();
 
     if (!ov || !ret)
         return NULL;
 
     for (x = 0; x < ret->wid; x++)
-        for (y = 0; y < ret->hei; y++)
-            if (selection_getpoint(x, y, ov) && match_maptyps(typ, levl[x][y].typ)) {
+        for (w = ov->map[x]; w; w &= w - 1UL) {
+            y = sel_lowbit(w);
+            if (match_maptyps(typ, levl[x][y].typ)) {
                 switch (lit) {
                 default:
                 case -2:
@@ -4254,48 +4385,35 @@ selection_filter_mapchar(struct selectionvar* ov,  xchar typ, int lit)
                     break;
                 }
             }
+        }
     return ret;
 }
 
 void
 selection_filter_percent(struct selectionvar* ov, int percent)
 {
-    int x, y;
+    int x;
+    unsigned long w, bit;
 
     if (!ov)
         return;
     for (x = 0; x < ov->wid; x++)
-        for (y = 0; y < ov->hei; y++)
-            if (selection_getpoint(x, y, ov) && (rn2(100) >= percent))
-                selection_setpoint(x, y, ov, 0);
+        for (w = ov->map[x]; w; w &= ~bit) {
+            bit = w & (~w + 1UL); /* lowest set bit */
+            if (rn2(100) >= percent)
+                ov->map[x] &= ~bit;
+        }
 }
 
 int
 selection_rndcoord(struct selectionvar* ov, xchar *x, xchar *y, boolean removeit)
 {
-    int idx = 0;
-    int c;
-    int dx, dy;
+    int idx = selection_numpoints(ov);
 
-    for (dx = 0; dx < ov->wid; dx++)
-        for (dy = 0; dy < ov->hei; dy++)
-            if (selection_getpoint(dx, dy, ov))
-                idx++;
-
-    if (idx) {
-        c = rn2(idx);
-        for (dx = 0; dx < ov->wid; dx++)
-            for (dy = 0; dy < ov->hei; dy++)
-                if (selection_getpoint(dx, dy, ov)) {
-                    if (!c) {
-                        *x = dx;
-                        *y = dy;
-                        if (removeit)
-                            selection_setpoint(dx, dy, ov, 0);
-                        return 1;
-                    }
-                    c--;
-                }
+    if (idx && selection_nthpoint(ov, rn2(idx), x, y)) {
+        if (removeit)
+            selection_setpoint(*x, *y, ov, 0);
+        return 1;
     }
     *x = *y = -1;
     return 0;
@@ -4304,38 +4422,46 @@ selection_rndcoord(struct selectionvar* ov, xchar *x, xchar *y, boolean removeit
 void
 selection_do_grow(struct selectionvar* ov, int dir)
 {
-    int x, y;
+    int x;
+    unsigned long cur, left, right, grow, mask;
     struct selectionvar *tmp = selection_new();
 
     if (!ov || !tmp)
         return;
 
-    for (x = 1; x < ov->wid; x++)
-        for (y = 0; y < ov->hei; y++) {
-            /* note:  dir is a mask of multiple directions, but the only
-               way to specify diagonals is by including the two adjacent
-               orthogonal directions, which effectively specifies three-
-               way growth [WEST|NORTH => WEST plus WEST|NORTH plus NORTH] */
-            if (((dir & W_WEST) && selection_getpoint(x + 1, y, ov))
-                || (((dir & (W_WEST | W_NORTH)) == (W_WEST | W_NORTH))
-                    && selection_getpoint(x + 1, y + 1, ov))
-                || ((dir & W_NORTH) && selection_getpoint(x, y + 1, ov))
-                || (((dir & (W_NORTH | W_EAST)) == (W_NORTH | W_EAST))
-                    && selection_getpoint(x - 1, y + 1, ov))
-                || ((dir & W_EAST) && selection_getpoint(x - 1, y, ov))
-                || (((dir & (W_EAST | W_SOUTH)) == (W_EAST | W_SOUTH))
-                    && selection_getpoint(x - 1, y - 1, ov))
-                || ((dir & W_SOUTH) && selection_getpoint(x, y - 1, ov))
-                ||  (((dir & (W_SOUTH | W_WEST)) == (W_SOUTH | W_WEST))
-                     && selection_getpoint(x + 1, y - 1, ov))) {
-                selection_setpoint(x, y, tmp, 1);
-            }
-        }
+    mask = SEL_COLMASK(ov);
+    /* column 0 is never grown into; map column 0 is not used */
+    for (x = 1; x < ov->wid; x++) {
+        cur = ov->map[x];
+        left = ov->map[x - 1];
+        right = (x + 1 < ov->wid) ? ov->map[x + 1] : 0UL;
+        /* note:  dir is a mask of multiple directions, but the only
+           way to specify diagonals is by including the two adjacent
+           orthogonal directions, which effectively specifies three-
+           way growth [WEST|NORTH => WEST plus WEST|NORTH plus NORTH];
+           moving one row north is a right shift, one row south a left */
+        grow = 0UL;
+        if (dir & W_WEST)
+            grow |= right;
+        if ((dir & (W_WEST | W_NORTH)) == (W_WEST | W_NORTH))
+            grow |= right >> 1;
+        if (dir & W_NORTH)
+            grow |= cur >> 1;
+        if ((dir & (W_NORTH | W_EAST)) == (W_NORTH | W_EAST))
+            grow |= left >> 1;
+        if (dir & W_EAST)
+            grow |= left;
+        if ((dir & (W_EAST | W_SOUTH)) == (W_EAST | W_SOUTH))
+            grow |= left << 1;
+        if (dir & W_SOUTH)
+            grow |= cur << 1;
+        if ((dir & (W_SOUTH | W_WEST)) == (W_SOUTH | W_WEST))
+            grow |= right << 1;
+        tmp->map[x] = grow & mask;
+    }
 
     for (x = 1; x < ov->wid; x++)
-        for (y = 0; y < ov->hei; y++)
-            if (selection_getpoint(x, y, tmp))
-                selection_setpoint(x, y, ov, 1);
+        ov->map[x] |= tmp->map[x];
 
     selection_free(tmp, TRUE);
 }
@@ -4370,31 +4496,20 @@ floodfillchk_match_accessible(int x, int y)
             || levl[x][y].typ == SCORR);
 }
 
-/* check whethere <x,y> is already in xs[],ys[] */
-static boolean
-sel_flood_havepoint(int x, int y, xchar xs[], xchar ys[], int n)
-{
-    xchar xx = (xchar) x, yy = (xchar) y;
-
-    while (n > 0) {
-        --n;
-        if (xs[n] == xx && ys[n] == yy)
-            return TRUE;
-    }
-    return FALSE;
-}
-
 void
 selection_floodfill(struct selectionvar* ov, int x, int y, boolean diagonals)
 {
     struct selectionvar *tmp = selection_new();
 #define SEL_FLOOD_STACK (COLNO * ROWNO)
+/* 'tmp' marks every point which has been pushed onto the stack, so a
+   point is only ever pushed once */
 #define SEL_FLOOD(nx, ny) \
     do {                                      \
         if (idx < SEL_FLOOD_STACK) {          \
             dx[idx] = (nx);                   \
             dy[idx] = (ny);                   \
             idx++;                            \
+            selection_setpoint((nx), (ny), tmp, 1); \
         } else                                \
             panic(floodfill_stack_overrun);   \
     } while (0)
@@ -4402,8 +4517,7 @@ selection_floodfill(struct selectionvar* ov, int x, int y, boolean diagonals)
     do {                                                        \
         if (isok((mx), (my))                                    \
             && (*selection_flood_check_func)((mx), (my))        \
-            && !selection_getpoint((mx), (my), (sel))           \
-            && !sel_flood_havepoint((mx), (my), dx, dy, idx))   \
+            && !selection_getpoint((mx), (my), (sel)))          \
             SEL_FLOOD((mx), (my));                              \
     } while (0)
     static const char floodfill_stack_overrun[] = "floodfill stack overrun";
@@ -4420,10 +4534,8 @@ selection_floodfill(struct selectionvar* ov, int x, int y, boolean diagonals)
         idx--;
         x = dx[idx];
         y = dy[idx];
-        if (isok(x, y)) {
+        if (isok(x, y))
             selection_setpoint(x, y, ov, 1);
-            selection_setpoint(x, y, tmp, 1);
-        }
         SEL_FLOOD_CHKDIR((x + 1), y, tmp);
         SEL_FLOOD_CHKDIR((x - 1), y, tmp);
         SEL_FLOOD_CHKDIR(x, (y + 1), tmp);
@@ -4717,16 +4829,15 @@ selection_iterate(
     select_iter_func func,
     genericptr_t arg)
 {
-    int x, y;
+    int x;
+    unsigned long w;
 
     if (!ov)
         return;
 
-    /* yes, this is very naive, but it's not _that_ expensive. */
     for (x = 0; x < ov->wid; x++)
-        for (y = 0; y < ov->hei; y++)
-            if (selection_getpoint(x, y, ov))
-                (*func)(x, y, arg);
+        for (w = ov->map[x]; w; w &= w - 1UL)
+            (*func)(x, sel_lowbit(w), arg);
 }
 
 static void
@@ -41,6 +41,7 @@ sys_early_init(void)
     sysopt.genericusers = (char *) 0;
     sysopt.maxplayers = 0; /* XXX eventually replace MAX_NR_OF_PLAYERS */
     sysopt.bones_pools = 0;
+    sysopt.levelstore = 0;
 
     /* record file */
     sysopt.persmax = max(PERSMAX, 1);
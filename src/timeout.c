@@ -1656,7 +1656,7 @@ do_storms(void)
  *      Start a timer of kind 'kind' that will expire at time
  *      g.monstermoves+'timeout'.  Call the function at 'func_index'
  *      in the timeout table using argument 'arg'.  Return TRUE if
- *      a timer was started.  This places the timer on a list ordered
+ *      a timer was started.  This places the timer in a queue ordered
  *      "sooner" to "later".  If an object, increment the object's
  *      timer count.
  *
@@ -1688,6 +1688,9 @@ do_storms(void)
  *      Relink all object and monster timers that had been saved
  *      using their object's or monster's id number.
  *
+ *  void rehash_timer(timer_element *timer)
+ *      Reindex a timer whose argument has been changed in place.
+ *
  * Object Specific:
  *  void obj_move_timers(struct obj *src, struct obj *dest)
  *      Reassign all timers from src to dest.
@@ -1702,10 +1705,25 @@ do_storms(void)
  *      Check whether object has a timer of type timer_type.
  */
 
+struct timer_run;
+
 static const char *kind_name(short);
-static void print_queue(winid, timer_element *);
+static void print_queue(winid);
+static unsigned arg_hash_of(ANY_P *);
+static void hash_timer(timer_element *);
+static void unhash_timer(timer_element *);
+static boolean timer_before(timer_element *, timer_element *);
+static int arg_timers(ANY_P *, short, short, timer_element **);
+static struct timer_run *find_run(long);
+static void free_run(struct timer_run *);
+static void tw_place(struct timer_run *);
+static void tw_unplace(struct timer_run *);
+static void tw_cascade(struct timer_run **);
+static void tw_skip(void);
+static int QSORTCALLBACK run_cmp(const genericptr, const genericptr);
+static timer_element **sorted_timers(int *);
 static void insert_timer(timer_element *);
-static timer_element *remove_timer(timer_element **, short, ANY_P *);
+static void remove_timer(timer_element *);
 static void write_timer(NHFILE *, timer_element *);
 static boolean mon_is_local(struct monst *);
 static boolean timer_is_local(timer_element *);
@@ -1743,6 +1761,57 @@ static const ttable timeout_funcs[NUM_TIME_FUNCS] = {
 };
 #undef TTAB
 
+/*
+ * The timer queue.
+ *
+ * Every timer is on the g.timer_base chain, in no particular order, for
+ * the things that need to look at all of them.  The queue itself is
+ * made of "runs":  all the timers going off on the same turn, most
+ * recently inserted first.  That is where the old sorted list put ties,
+ * so walking each run from its head gives the same firing order (and
+ * the same order in save files) as before.  Runs are hashed by their
+ * timeout and hung on a hierarchical timing wheel:  level 0 has a slot
+ * for each turn of the current 256 turn block, level 1 one for each 256
+ * turn block of the current 65536 turn block, and level 2 one for each
+ * of those within the current 2^24 turns; anything further off waits
+ * on tw_far.  Whenever tw_now crosses a block boundary, the slot above
+ * is cascaded down.  Runs for turns tw_now has already passed (restored
+ * from bones, or started with no delay while run_timers() is going)
+ * are kept on tw_late, sorted, and are always served first.
+ *
+ * Timers are also hashed by their argument, so finding the timers for
+ * an object or a spot only looks at a few of them.
+ */
+struct timer_run {
+    struct timer_run *hnext, **hprevp; /* runs with the same hash */
+    struct timer_run *snext, **sprevp; /* runs in the same wheel slot */
+    timer_element *timers;             /* timers going off, in order */
+    long timeout;                      /* when they go off */
+    int where;                         /* TW_LEVEL0 .. TW_LATE */
+};
+
+#define TW_BITS 8
+#define TW_SIZE (1 << TW_BITS)
+#define TW_MASK (TW_SIZE - 1)
+#define TW_LEVELS 3
+/* where a run is; the wheel levels come first */
+#define TW_FAR TW_LEVELS
+#define TW_LATE (TW_LEVELS + 1)
+/* first turn of the block which level 'lvl' covers */
+#define tw_block(t, lvl) ((t) >> (((lvl) + 1) * TW_BITS))
+
+#define RUN_HASHSZ 1024 /* power of 2 */
+#define ARG_HASHSZ 4096 /* power of 2 */
+/* an object or spot never has more timers than this */
+#define MAX_ARG_TIMERS (NUM_TIMER_KINDS * NUM_TIME_FUNCS)
+
+static struct timer_run *tw_wheel[TW_LEVELS][TW_SIZE], *tw_far, *tw_late;
+static long tw_now;                 /* next turn for the wheel to serve */
+static int tw_count[TW_LATE + 1];   /* runs at each level, tw_far, tw_late */
+static int tw_nruns;                /* runs altogether */
+static struct timer_run *run_hash[RUN_HASHSZ];
+static timer_element *arg_hash[ARG_HASHSZ];
+
 static const char *
 kind_name(short kind)
 {
@@ -1760,16 +1829,19 @@ kind_name(short kind)
 }
 
 static void
-print_queue(winid win, timer_element* base)
+print_queue(winid win)
 {
-    timer_element *curr;
+    timer_element *curr, **queue;
+    int i, count;
     char buf[BUFSZ];
 
-    if (!base) {
+    if (!g.timer_base) {
         putstr(win, 0, " <empty>");
     } else {
         putstr(win, 0, "timeout  id   kind   call");
-        for (curr = base; curr; curr = curr->next) {
+        queue = sorted_timers(&count);
+        for (i = 0; i < count; ++i) {
+            curr = queue[i];
 #ifdef VERBOSE_TIMER
             Sprintf(buf, " %4ld   %4ld  %-6s %s(%s)", curr->timeout,
                     curr->tid, kind_name(curr->kind),
@@ -1782,6 +1854,7 @@ print_queue(winid win, timer_element* base)
 #endif
             putstr(win, 0, buf);
         }
+        free((genericptr_t) queue);
     }
 }
 
@@ -1803,7 +1876,7 @@ wiz_timeout_queue(void)
     putstr(win, 0, "");
     putstr(win, 0, "Active timeout queue:");
     putstr(win, 0, "");
-    print_queue(win, g.timer_base);
+    print_queue(win);
 
     /* Timed properies:
      * check every one; the majority can't obtain temporary timeouts in
@@ -1857,7 +1930,7 @@ timer_sanity_check(void)
     timer_element *curr;
 
     /* this should be much more complete */
-    for (curr = g.timer_base; curr; curr = curr->next)
+    for (curr = g.timer_base; curr; curr = curr->next) {
         if (curr->kind == TIMER_OBJECT) {
             struct obj *obj = curr->arg.a_obj;
 
@@ -1866,6 +1939,10 @@ timer_sanity_check(void)
                       fmt_ptr((genericptr_t) obj), curr->tid);
             }
         }
+        if (!curr->run || curr->run->timeout != curr->timeout)
+            impossible("timer sanity: timer %ld (%ld) misfiled", curr->tid,
+                       curr->timeout);
+    }
 }
 
 /*
@@ -1875,16 +1952,25 @@ timer_sanity_check(void)
 void
 run_timers(void)
 {
+    struct timer_run *run;
     timer_element *curr;
 
     /*
-     * Always use the first element.  Elements may be added or deleted at
-     * any time.  The list is ordered, we are done when the first element
-     * is in the future.
+     * Always use the first element of the earliest run.  Elements may be
+     * added or deleted at any time, so look again after each one.  We
+     * are done when the wheel has caught up with the move count.
      */
-    while (g.timer_base && g.timer_base->timeout <= g.monstermoves) {
-        curr = g.timer_base;
-        g.timer_base = curr->next;
+    for (;;) {
+        if (!(run = tw_late)) {
+            if (tw_now > g.monstermoves)
+                break;
+            if (!(run = tw_wheel[0][tw_now & TW_MASK])) {
+                tw_skip();
+                continue;
+            }
+        }
+        curr = run->timers;
+        remove_timer(curr);
 
         if (curr->kind == TIMER_OBJECT)
             (curr->arg.a_obj)->timed--;
@@ -1903,19 +1989,14 @@ start_timer(
     short func_index,
     anything *arg)
 {
-    timer_element *gnu, *dup;
+    timer_element *gnu, *dup[MAX_ARG_TIMERS];
 
     if (kind < 0 || kind >= NUM_TIMER_KINDS
         || func_index < 0 || func_index >= NUM_TIME_FUNCS)
         panic("start_timer (%s: %d)", kind_name(kind), (int) func_index);
 
     /* fail if <arg> already has a <func_index> timer running */
-    for (dup = g.timer_base; dup; dup = dup->next)
-        if (dup->kind == kind
-            && dup->func_index == func_index
-            && dup->arg.a_void == arg->a_void)
-            break;
-    if (dup) {
+    if (arg_timers(arg, kind, func_index, dup)) {
         char idbuf[QBUFSZ];
 
 #ifdef VERBOSE_TIMER
@@ -1951,12 +2032,12 @@ start_timer(
 long
 stop_timer(short func_index, anything *arg)
 {
-    timer_element *doomed;
+    timer_element *doomed, *list[MAX_ARG_TIMERS];
     long timeout;
 
-    doomed = remove_timer(&g.timer_base, func_index, arg);
-
-    if (doomed) {
+    if (arg_timers(arg, -1, func_index, list)) {
+        doomed = list[0];
+        remove_timer(doomed);
         timeout = doomed->timeout;
         if (doomed->kind == TIMER_OBJECT)
             (arg->a_obj)->timed--;
@@ -1974,12 +2055,10 @@ stop_timer(short func_index, anything *arg)
 long
 peek_timer(short type, anything *arg)
 {
-    timer_element *curr;
+    timer_element *list[MAX_ARG_TIMERS];
 
-    for (curr = g.timer_base; curr; curr = curr->next) {
-        if (curr->func_index == type && curr->arg.a_void == arg->a_void)
-            return curr->timeout;
-    }
+    if (arg_timers(arg, -1, type, list))
+        return list[0]->timeout;
     return 0L;
 }
 
@@ -1989,15 +2068,15 @@ peek_timer(short type, anything *arg)
 void
 obj_move_timers(struct obj* src, struct obj* dest)
 {
-    int count;
-    timer_element *curr;
-
-    for (count = 0, curr = g.timer_base; curr; curr = curr->next)
-        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == src) {
-            curr->arg.a_obj = dest;
-            dest->timed++;
-            count++;
-        }
+    int i, count;
+    timer_element *list[MAX_ARG_TIMERS];
+
+    count = arg_timers(obj_to_any(src), TIMER_OBJECT, -1, list);
+    for (i = 0; i < count; ++i) {
+        list[i]->arg.a_obj = dest;
+        rehash_timer(list[i]);
+        dest->timed++;
+    }
     if (count != src->timed)
         panic("obj_move_timers");
     src->timed = 0;
@@ -2009,15 +2088,14 @@ obj_move_timers(struct obj* src, struct obj* dest)
 void
 obj_split_timers(struct obj* src, struct obj* dest)
 {
-    timer_element *curr, *next_timer = 0;
-
-    for (curr = g.timer_base; curr; curr = next_timer) {
-        next_timer = curr->next; /* things may be inserted */
-        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == src) {
-            (void) start_timer(curr->timeout - g.monstermoves, TIMER_OBJECT,
-                               curr->func_index, obj_to_any(dest));
-        }
-    }
+    int i, count;
+    timer_element *list[MAX_ARG_TIMERS];
+
+    /* in queue order, so that ties between them go the same way */
+    count = arg_timers(obj_to_any(src), TIMER_OBJECT, -1, list);
+    for (i = 0; i < count; ++i)
+        (void) start_timer(list[i]->timeout - g.monstermoves, TIMER_OBJECT,
+                           list[i]->func_index, obj_to_any(dest));
 }
 
 /*
@@ -2027,22 +2105,17 @@ obj_split_timers(struct obj* src, struct obj* dest)
 void
 obj_stop_timers(struct obj* obj)
 {
-    timer_element *curr, *prev, *next_timer = 0;
-
-    for (prev = 0, curr = g.timer_base; curr; curr = next_timer) {
-        next_timer = curr->next;
-        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == obj) {
-            if (prev)
-                prev->next = curr->next;
-            else
-                g.timer_base = curr->next;
-            if (timeout_funcs[curr->func_index].cleanup)
-                (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
-                                                           curr->timeout);
-            free((genericptr_t) curr);
-        } else {
-            prev = curr;
-        }
+    int i, count;
+    timer_element *curr, *list[MAX_ARG_TIMERS];
+
+    count = arg_timers(obj_to_any(obj), TIMER_OBJECT, -1, list);
+    for (i = 0; i < count; ++i) {
+        curr = list[i];
+        remove_timer(curr);
+        if (timeout_funcs[curr->func_index].cleanup)
+            (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
+                                                       curr->timeout);
+        free((genericptr_t) curr);
     }
     obj->timed = 0;
 }
@@ -2065,24 +2138,20 @@ obj_has_timer(struct obj* object, short timer_type)
 void
 spot_stop_timers(xchar x, xchar y, short func_index)
 {
-    timer_element *curr, *prev, *next_timer = 0;
-    long where = (((long) x << 16) | ((long) y));
-
-    for (prev = 0, curr = g.timer_base; curr; curr = next_timer) {
-        next_timer = curr->next;
-        if (curr->kind == TIMER_LEVEL && curr->func_index == func_index
-            && curr->arg.a_long == where) {
-            if (prev)
-                prev->next = curr->next;
-            else
-                g.timer_base = curr->next;
-            if (timeout_funcs[curr->func_index].cleanup)
-                (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
-                                                           curr->timeout);
-            free((genericptr_t) curr);
-        } else {
-            prev = curr;
-        }
+    int i, count;
+    timer_element *curr, *list[MAX_ARG_TIMERS];
+    anything where;
+
+    where = cg.zeroany;
+    where.a_long = (((long) x << 16) | ((long) y));
+    count = arg_timers(&where, TIMER_LEVEL, func_index, list);
+    for (i = 0; i < count; ++i) {
+        curr = list[i];
+        remove_timer(curr);
+        if (timeout_funcs[curr->func_index].cleanup)
+            (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
+                                                       curr->timeout);
+        free((genericptr_t) curr);
     }
 }
 
@@ -2093,14 +2162,13 @@ spot_stop_timers(xchar x, xchar y, short func_index)
 long
 spot_time_expires(xchar x, xchar y, short func_index)
 {
-    timer_element *curr;
-    long where = (((long) x << 16) | ((long) y));
+    timer_element *list[MAX_ARG_TIMERS];
+    anything where;
 
-    for (curr = g.timer_base; curr; curr = curr->next) {
-        if (curr->kind == TIMER_LEVEL && curr->func_index == func_index
-            && curr->arg.a_long == where)
-            return curr->timeout;
-    }
+    where = cg.zeroany;
+    where.a_long = (((long) x << 16) | ((long) y));
+    if (arg_timers(&where, TIMER_LEVEL, func_index, list))
+        return list[0]->timeout;
     return 0L;
 }
 
@@ -2111,43 +2179,265 @@ spot_time_left(xchar x, xchar y, short func_index)
     return (expires > 0L) ? expires - g.monstermoves : 0L;
 }
 
-/* Insert timer into the global queue */
+static unsigned
+arg_hash_of(anything *arg)
+{
+    unsigned long h = (unsigned long) (size_t) arg->a_void;
+
+    return (unsigned) ((h >> 4) ^ (h >> 14) ^ (h >> 24)) & (ARG_HASHSZ - 1);
+}
+
 static void
-insert_timer(timer_element* gnu)
+hash_timer(timer_element *te)
 {
-    timer_element *curr, *prev;
+    timer_element **head = &arg_hash[arg_hash_of(&te->arg)];
 
-    for (prev = 0, curr = g.timer_base; curr; prev = curr, curr = curr->next)
-        if (curr->timeout >= gnu->timeout)
-            break;
+    if ((te->anext = *head) != 0)
+        te->anext->aprevp = &te->anext;
+    te->aprevp = head;
+    *head = te;
+}
 
-    gnu->next = curr;
-    if (prev)
-        prev->next = gnu;
-    else
-        g.timer_base = gnu;
+static void
+unhash_timer(timer_element *te)
+{
+    if ((*te->aprevp = te->anext) != 0)
+        te->anext->aprevp = te->aprevp;
 }
 
-static timer_element *
-remove_timer(
-    timer_element **base,
-    short func_index,
-    anything *arg)
+/* the argument of a queued timer has been changed; refile it */
+void
+rehash_timer(timer_element *te)
 {
-    timer_element *prev, *curr;
+    unhash_timer(te);
+    hash_timer(te);
+}
 
-    for (prev = 0, curr = *base; curr; prev = curr, curr = curr->next)
-        if (curr->func_index == func_index && curr->arg.a_void == arg->a_void)
+/* does timer a go off before timer b? */
+static boolean
+timer_before(timer_element *a, timer_element *b)
+{
+    if (a->timeout != b->timeout)
+        return (boolean) (a->timeout < b->timeout);
+    while ((a = a->rnext) != 0)
+        if (a == b)
+            return TRUE;
+    return FALSE;
+}
+
+/*
+ * Collect the timers for arg, optionally only those of one kind or one
+ * function, in the order they will go off.  Returns how many there are.
+ */
+static int
+arg_timers(
+    anything *arg,
+    short kind,
+    short func_index,
+    timer_element **list)
+{
+    timer_element *curr;
+    int i, n = 0;
+
+    for (curr = arg_hash[arg_hash_of(arg)]; curr; curr = curr->anext) {
+        if (curr->arg.a_void != arg->a_void
+            || (kind >= 0 && curr->kind != kind)
+            || (func_index >= 0 && curr->func_index != func_index))
+            continue;
+        if (n == MAX_ARG_TIMERS) {
+            impossible("arg_timers: too many timers for %s",
+                       fmt_ptr((genericptr_t) arg->a_void));
             break;
+        }
+        for (i = n; i > 0 && timer_before(curr, list[i - 1]); --i)
+            list[i] = list[i - 1];
+        list[i] = curr;
+        n++;
+    }
+    return n;
+}
+
+/* find the run for timeout 'when', starting a new one if there is none */
+static struct timer_run *
+find_run(long when)
+{
+    struct timer_run *run, **head = &run_hash[when & (RUN_HASHSZ - 1)];
+
+    for (run = *head; run; run = run->hnext)
+        if (run->timeout == when)
+            return run;
+
+    run = (struct timer_run *) alloc(sizeof *run);
+    (void) memset((genericptr_t) run, 0, sizeof *run);
+    run->timeout = when;
+    if ((run->hnext = *head) != 0)
+        run->hnext->hprevp = &run->hnext;
+    run->hprevp = head;
+    *head = run;
+    /* an empty wheel can start wherever suits */
+    if (!tw_nruns++)
+        tw_now = min(when, g.monstermoves);
+    tw_place(run);
+    return run;
+}
+
+static void
+free_run(struct timer_run *run)
+{
+    if ((*run->hprevp = run->hnext) != 0)
+        run->hnext->hprevp = run->hprevp;
+    tw_unplace(run);
+    tw_nruns--;
+    free((genericptr_t) run);
+}
 
-    if (curr) {
-        if (prev)
-            prev->next = curr->next;
+/* put a run in the wheel slot, or on the list, where it belongs */
+static void
+tw_place(struct timer_run *run)
+{
+    long when = run->timeout;
+    struct timer_run **slot;
+    int lvl;
+
+    if (when < tw_now) {
+        lvl = TW_LATE;
+        for (slot = &tw_late; *slot; slot = &(*slot)->snext)
+            if ((*slot)->timeout > when)
+                break;
+    } else {
+        for (lvl = 0; lvl < TW_LEVELS; ++lvl)
+            if (tw_block(when, lvl) == tw_block(tw_now, lvl))
+                break;
+        if (lvl < TW_LEVELS)
+            slot = &tw_wheel[lvl][(when >> (lvl * TW_BITS)) & TW_MASK];
         else
-            *base = curr->next;
+            slot = &tw_far;
     }
+    run->where = lvl;
+    tw_count[lvl]++;
+    if ((run->snext = *slot) != 0)
+        run->snext->sprevp = &run->snext;
+    run->sprevp = slot;
+    *slot = run;
+}
+
+static void
+tw_unplace(struct timer_run *run)
+{
+    if ((*run->sprevp = run->snext) != 0)
+        run->snext->sprevp = run->sprevp;
+    tw_count[run->where]--;
+}
 
-    return curr;
+/* redistribute the runs in a slot after tw_now has moved on */
+static void
+tw_cascade(struct timer_run **slot)
+{
+    struct timer_run *run, *nextrun;
+
+    for (run = *slot, *slot = 0; run; run = nextrun) {
+        nextrun = run->snext;
+        tw_count[run->where]--;
+        tw_place(run);
+    }
+}
+
+/* nothing goes off at tw_now; advance it as far as is safe */
+static void
+tw_skip(void)
+{
+    long next = tw_now + 1L;
+    int lvl;
+
+    /* skip to the end of the block of the highest empty level */
+    for (lvl = 0; lvl < TW_LEVELS && !tw_count[lvl]; ++lvl)
+        next = (tw_now | ((1L << ((lvl + 1) * TW_BITS)) - 1L)) + 1L;
+    if (lvl == TW_LEVELS && !tw_count[TW_FAR])
+        next = g.monstermoves + 1L;
+    if (next > g.monstermoves + 1L)
+        next = g.monstermoves + 1L;
+
+    tw_now = next;
+    if (!(next & TW_MASK)) {
+        if (!(tw_block(next, 0) & TW_MASK)) {
+            if (!(tw_block(next, 1) & TW_MASK))
+                tw_cascade(&tw_far);
+            tw_cascade(&tw_wheel[2][tw_block(next, 1) & TW_MASK]);
+        }
+        tw_cascade(&tw_wheel[1][tw_block(next, 0) & TW_MASK]);
+    }
+}
+
+static int QSORTCALLBACK
+run_cmp(const genericptr vptr1, const genericptr vptr2)
+{
+    long t1 = (*(struct timer_run **) vptr1)->timeout,
+         t2 = (*(struct timer_run **) vptr2)->timeout;
+
+    return (t1 < t2) ? -1 : (t1 > t2);
+}
+
+/* all the timers, in the order they will go off; caller frees the list */
+static timer_element **
+sorted_timers(int *countp)
+{
+    struct timer_run **runs, *run;
+    timer_element *curr, **queue;
+    int i, n, count = 0;
+
+    for (curr = g.timer_base; curr; curr = curr->next)
+        count++;
+    queue = (timer_element **) alloc((unsigned) ((count + 1)
+                                                 * sizeof *queue));
+    runs = (struct timer_run **) alloc((unsigned) ((tw_nruns + 1)
+                                                   * sizeof *runs));
+    for (n = i = 0; i < RUN_HASHSZ; ++i)
+        for (run = run_hash[i]; run; run = run->hnext)
+            runs[n++] = run;
+    qsort((genericptr_t) runs, (size_t) n, sizeof *runs, run_cmp);
+    for (count = i = 0; i < n; ++i)
+        for (curr = runs[i]->timers; curr; curr = curr->rnext)
+            queue[count++] = curr;
+    free((genericptr_t) runs);
+    *countp = count;
+    return queue;
+}
+
+/*
+ * Insert timer into the global queue.  It goes off before any others
+ * with the same timeout.
+ */
+static void
+insert_timer(timer_element *gnu)
+{
+    struct timer_run *run = find_run(gnu->timeout);
+
+    if ((gnu->next = g.timer_base) != 0)
+        gnu->next->prevp = &gnu->next;
+    gnu->prevp = &g.timer_base;
+    g.timer_base = gnu;
+
+    gnu->run = run;
+    if ((gnu->rnext = run->timers) != 0)
+        gnu->rnext->rprevp = &gnu->rnext;
+    gnu->rprevp = &run->timers;
+    run->timers = gnu;
+
+    hash_timer(gnu);
+}
+
+/* take timer out of the global queue; the caller frees it */
+static void
+remove_timer(timer_element *doomed)
+{
+    if ((*doomed->prevp = doomed->next) != 0)
+        doomed->next->prevp = doomed->prevp;
+    if ((*doomed->rprevp = doomed->rnext) != 0)
+        doomed->rnext->rprevp = doomed->rprevp;
+    unhash_timer(doomed);
+    if (!doomed->run->timers)
+        free_run(doomed->run);
+    doomed->run = 0;
 }
 
 static void
@@ -2274,10 +2564,14 @@ timer_is_local(timer_element* timer)
 static int
 maybe_write_timer(NHFILE* nhfp, int range, boolean write_it)
 {
-    int count = 0;
-    timer_element *curr;
-
-    for (curr = g.timer_base; curr; curr = curr->next) {
+    int i, n, count = 0;
+    timer_element *curr, **queue;
+
+    /* timers are written in queue order so that restore_timers() can
+       put them back in the same order */
+    queue = sorted_timers(&n);
+    for (i = 0; i < n; ++i) {
+        curr = queue[i];
         if (range == RANGE_GLOBAL) {
             /* global timers */
 
@@ -2294,6 +2588,7 @@ maybe_write_timer(NHFILE* nhfp, int range, boolean write_it)
             }
         }
     }
+    free((genericptr_t) queue);
 
     return count;
 }
@@ -2315,7 +2610,7 @@ maybe_write_timer(NHFILE* nhfp, int range, boolean write_it)
 void
 save_timers(NHFILE* nhfp, int range)
 {
-    timer_element *curr, *prev, *next_timer = 0;
+    timer_element *curr, *next_timer = 0;
     int count;
 
     if (perform_bwrite(nhfp)) {
@@ -2330,18 +2625,12 @@ save_timers(NHFILE* nhfp, int range)
     }
 
     if (release_data(nhfp)) {
-        for (prev = 0, curr = g.timer_base; curr; curr = next_timer) {
+        for (curr = g.timer_base; curr; curr = next_timer) {
             next_timer = curr->next; /* in case curr is removed */
 
             if (!(!!(range == RANGE_LEVEL) ^ !!timer_is_local(curr))) {
-                if (prev)
-                    prev->next = curr->next;
-                else
-                    g.timer_base = curr->next;
+                remove_timer(curr);
                 free((genericptr_t) curr);
-                /* prev stays the same */
-            } else {
-                prev = curr;
             }
         }
     }
@@ -2391,6 +2680,7 @@ timer_stats(const char* hdrfmt, char *hdrbuf, long *count, long *size)
         ++*count;
         *size += (long) sizeof *te;
     }
+    *size += (long) tw_nruns * (long) sizeof (struct timer_run);
 }
 
 RESTORE_WARNING_FORMAT_NONLITERAL
@@ -2414,6 +2704,7 @@ relink_timers(boolean ghostly)
                 if (!curr->arg.a_obj)
                     panic("cant find o_id %d", nid);
                 curr->needs_fixup = 0;
+                rehash_timer(curr);
             } else if (curr->kind == TIMER_MONSTER) {
                 panic("relink_timers: no monster timer implemented");
             } else
@@ -5,6 +5,10 @@
 
 #include "hack.h"
 #include "dlb.h"
+#ifdef UNIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
 
 #if defined(VMS) && !defined(UPDATE_RECORD_IN_PLACE)
 /* We don't want to rewrite the whole file, because that entails
@@ -14,6 +18,28 @@
 #define UPDATE_RECORD_IN_PLACE
 #endif
 
+#if defined(UNIX) && !defined(UPDATE_RECORD_IN_PLACE)
+/* Rewriting just the entries from the first one that changes onward
+   keeps the time 'record' is locked short when many games end at once,
+   and truncating it afterwards is straightforward.  Rewriting the whole
+   file by reopening it would also drop the fcntl() lock on it.  */
+#define UPDATE_RECORD_IN_PLACE
+#define TRUNCATE_FILE
+#endif
+
+#if defined(UNIX) && defined(UPDATE_RECORD_IN_PLACE)
+/* topten() keeps RECORDINDEX up to date with 'record' so that prscore()
+   can find the entries it wants without reading through all of it */
+#define RECORD_INDEX
+#endif
+
+#if defined(UNIX) && defined(O_APPEND)
+/* Log file entries are appended with a single write() to a file opened
+   with O_APPEND, which puts them at the end of the file intact even if
+   other games are appending at the same time, so no lock is needed.  */
+#define ATOMIC_LOG_APPEND
+#endif
+
 /*
  * Updating in place can leave junk at the end of the file in some
  * circumstances (if it shrinks and the O.S. doesn't have a straightforward
@@ -53,6 +79,36 @@ struct toptenentry {
     char name[NAMSZ + 1];
     char death[DTHSZ + 1];
 } *tt_head;
+#ifdef RECORD_INDEX
+/*
+ * RECORDINDEX holds a header, a ttindexent for each entry in 'record'
+ * in rank order, and then for each TTIX_xxx key the entry numbers
+ * sorted by that key (and by rank among equal keys), so that the
+ * entries with a given name, role, race or uid can be found with a
+ * binary search.  The header's recsize and rectime are those of the
+ * 'record' file it was made for; if they don't match, the index is
+ * out of date and isn't used.
+ */
+struct ttindexhdr {
+    char magic[4];
+    long count;   /* number of entries */
+    long recsize; /* size of 'record' */
+    long rectime; /* modification time of 'record' */
+};
+struct ttindexent {
+    long fpos;    /* where the entry starts in 'record' */
+    int uid;
+    char plrole[ROLESZ + 1];
+    char plrace[ROLESZ + 1];
+    char name[NAMSZ + 1];
+};
+enum ttix_keys { TTIX_NAME = 0, TTIX_ROLE, TTIX_RACE, TTIX_UID, NUM_TTIX };
+#define TTIX_ROLE1 NUM_TTIX /* first letter of role; searches TTIX_ROLE */
+static const char ttix_magic[4] = { 'N', 'H', 'T', 'X' };
+static const struct ttindexent *ttix_ents; /* for ttix_sort_cmp() */
+static int ttix_key;                       /* likewise */
+#endif /* RECORD_INDEX */
+
 /* size big enough to read in all the string fields at once; includes
    room for separating space or trailing newline plus string terminator */
 #define SCANBUFSZ (4 * (ROLESZ + 1) + (NAMSZ + 1) + (DTHSZ + 1) + 1)
@@ -64,6 +120,29 @@ static void topten_print_bold(const char *);
 static void outheader(void);
 static void outentry(int, struct toptenentry *, boolean);
 static void discardexcess(FILE *);
+#if defined(LOGFILE) || defined(XLOGFILE)
+static boolean lock_logfile(const char *);
+static void unlock_logfile(const char *);
+static FILE *open_logfile(const char *);
+#endif
+#ifdef TRUNCATE_FILE
+static void truncate_file(FILE *);
+#endif
+#ifdef RECORD_INDEX
+static int QSORTCALLBACK ttix_sort_cmp(const genericptr, const genericptr);
+static int ttix_cmp(const struct ttindexent *, int, const char *, int);
+static void write_ttindex(FILE *);
+static FILE *open_ttindex(FILE *, struct ttindexhdr *);
+static boolean ttix_entno(FILE *, struct ttindexhdr *, int, long, long *);
+static boolean ttix_read(FILE *, struct ttindexhdr *, long,
+                         struct ttindexent *);
+static void ttix_add(long, long **, long *, long *);
+static boolean ttix_find(FILE *, struct ttindexhdr *, int, const char *,
+                         int, long **, long *, long *);
+static int QSORTCALLBACK ttix_entno_cmp(const genericptr, const genericptr);
+static long ttindex_lookup(FILE *, int, const char **, int, long **,
+                           struct ttindexent **);
+#endif
 static void readentry(FILE *, struct toptenentry *);
 static void writeentry(FILE *, struct toptenentry *);
 #ifdef XLOGFILE
@@ -200,6 +279,380 @@ observable_depth(d_level* lev)
     return depth(lev);
 }
 
+#if defined(LOGFILE) || defined(XLOGFILE)
+static boolean
+lock_logfile(const char *filename)
+{
+#ifdef ATOMIC_LOG_APPEND
+    nhUse(filename);
+    return TRUE;
+#else
+    return lock_file(filename, SCOREPREFIX, 10);
+#endif
+}
+
+static void
+unlock_logfile(const char *filename)
+{
+#ifdef ATOMIC_LOG_APPEND
+    nhUse(filename);
+#else
+    unlock_file(filename);
+#endif
+}
+
+/* open a log file to append one entry to; with ATOMIC_LOG_APPEND the
+   stream is fully buffered so that fclose() passes the whole entry to
+   a single write() */
+static FILE *
+open_logfile(const char *filename)
+{
+#ifdef ATOMIC_LOG_APPEND
+    static char logbuf[BUFSZ * 16]; /* more than an xlogfile line */
+    FILE *fp = (FILE *) 0;
+    int fd;
+
+    fd = open(fqname(filename, SCOREPREFIX, 0),
+              O_WRONLY | O_APPEND | O_CREAT, 0666);
+    if (fd >= 0 && !(fp = fdopen(fd, "a")))
+        (void) close(fd);
+    if (fp)
+        (void) setvbuf(fp, logbuf, _IOFBF, sizeof logbuf);
+    return fp;
+#else
+    return fopen_datafile(filename, "a", SCOREPREFIX);
+#endif
+}
+#endif /* LOGFILE || XLOGFILE */
+
+#ifdef TRUNCATE_FILE
+/* cut the record file off after what has just been written to it */
+static void
+truncate_file(FILE *rfile)
+{
+    long fpos;
+
+    (void) fflush(rfile);
+    if ((fpos = ftell(rfile)) >= 0L)
+        (void) ftruncate(fileno(rfile), (off_t) fpos);
+}
+#endif
+
+#ifdef RECORD_INDEX
+/* compare index entry e with the search key for 'which' */
+static int
+ttix_cmp(const struct ttindexent *e, int which, const char *key, int uid)
+{
+    switch (which) {
+    case TTIX_NAME:
+        return strncmp(e->name, key, NAMSZ);
+    case TTIX_ROLE:
+        return strcmp(e->plrole, key);
+    case TTIX_ROLE1:
+        return (int) (uchar) e->plrole[0] - (int) (uchar) *key;
+    case TTIX_RACE:
+        return strcmp(e->plrace, key);
+    case TTIX_UID:
+    default:
+        return (e->uid > uid) - (e->uid < uid);
+    }
+}
+
+static int QSORTCALLBACK
+ttix_sort_cmp(const genericptr vptr1, const genericptr vptr2)
+{
+    long i1 = *(const long *) vptr1, i2 = *(const long *) vptr2;
+    const struct ttindexent *e2 = &ttix_ents[i2];
+    int res = ttix_cmp(&ttix_ents[i1], ttix_key, (ttix_key == TTIX_NAME)
+                                                 ? e2->name
+                                                 : (ttix_key == TTIX_ROLE)
+                                                   ? e2->plrole
+                                                   : e2->plrace,
+                       e2->uid);
+
+    return res ? res : (i1 > i2) - (i1 < i2);
+}
+
+/* rewrite RECORDINDEX for the entries in tt_head, which has to hold
+   what is now in rfile, with the fpos of each entry up to date */
+static void
+write_ttindex(FILE *rfile)
+{
+    struct ttindexhdr hdr;
+    struct ttindexent *ents;
+    struct toptenentry *t1;
+    struct stat st;
+    long i, n, *order;
+    FILE *ixfile;
+    char tmpname[BUFSZ], ixname[BUFSZ];
+    boolean ok;
+
+    (void) fflush(rfile);
+    if (fstat(fileno(rfile), &st) < 0)
+        return;
+    for (n = 0, t1 = tt_head; t1->points != 0; t1 = t1->tt_next)
+        ++n;
+    ents = (struct ttindexent *) alloc((unsigned) (max(n, 1)
+                                                   * sizeof *ents));
+    order = (long *) alloc((unsigned) (max(n, 1) * sizeof *order));
+    for (i = 0, t1 = tt_head; i < n; ++i, t1 = t1->tt_next) {
+        (void) memset((genericptr_t) &ents[i], 0, sizeof ents[i]);
+        ents[i].fpos = t1->fpos;
+        ents[i].uid = t1->uid;
+        Strcpy(ents[i].plrole, t1->plrole);
+        Strcpy(ents[i].plrace, t1->plrace);
+        Strcpy(ents[i].name, t1->name);
+    }
+    (void) memcpy((genericptr_t) hdr.magic, (genericptr_t) ttix_magic,
+                  sizeof hdr.magic);
+    hdr.count = n;
+    hdr.recsize = (long) st.st_size;
+    hdr.rectime = (long) st.st_mtime;
+
+    /* build it beside the old one and then replace that, so that
+       prscore() never sees a partly written index */
+    Strcpy(ixname, fqname(RECORDINDEX, SCOREPREFIX, 0));
+    Snprintf(tmpname, sizeof tmpname, "%s.tmp", ixname);
+    if (!(ixfile = fopen(tmpname, "wb"))) {
+        free((genericptr_t) ents), free((genericptr_t) order);
+        return;
+    }
+    ok = (fwrite((genericptr_t) &hdr, sizeof hdr, 1, ixfile) == 1
+          && (!n || fwrite((genericptr_t) ents, sizeof *ents, (size_t) n,
+                           ixfile) == (size_t) n));
+    ttix_ents = ents;
+    for (ttix_key = 0; ok && ttix_key < NUM_TTIX; ++ttix_key) {
+        for (i = 0; i < n; ++i)
+            order[i] = i;
+        qsort((genericptr_t) order, (size_t) n, sizeof *order,
+              ttix_sort_cmp);
+        ok = (!n || fwrite((genericptr_t) order, sizeof *order, (size_t) n,
+                           ixfile) == (size_t) n);
+    }
+    ttix_ents = (struct ttindexent *) 0;
+    if (fclose(ixfile) == EOF)
+        ok = FALSE;
+    if (!ok || rename(tmpname, ixname) < 0)
+        (void) unlink(tmpname);
+    free((genericptr_t) ents);
+    free((genericptr_t) order);
+}
+
+/* open RECORDINDEX if it is up to date with rfile */
+static FILE *
+open_ttindex(FILE *rfile, struct ttindexhdr *hdr)
+{
+    struct stat st;
+    FILE *ixfile;
+
+    if (fstat(fileno(rfile), &st) < 0
+        || !(ixfile = fopen_datafile(RECORDINDEX, "rb", SCOREPREFIX)))
+        return (FILE *) 0;
+    if (fread((genericptr_t) hdr, sizeof *hdr, 1, ixfile) != 1
+        || memcmp((genericptr_t) hdr->magic, (genericptr_t) ttix_magic,
+                  sizeof hdr->magic)
+        || hdr->count < 0 || hdr->recsize != (long) st.st_size
+        || hdr->rectime != (long) st.st_mtime) {
+        (void) fclose(ixfile);
+        return (FILE *) 0;
+    }
+    return ixfile;
+}
+
+/* get the number of the entry at position 'pos' in the ordering by
+   'which' */
+static boolean
+ttix_entno(
+    FILE *ixfile,
+    struct ttindexhdr *hdr,
+    int which,
+    long pos,
+    long *entno)
+{
+    return (boolean) (fseek(ixfile, (long) sizeof *hdr
+                                    + hdr->count
+                                      * (long) sizeof (struct ttindexent)
+                                    + (which * hdr->count + pos)
+                                      * (long) sizeof *entno,
+                            SEEK_SET) >= 0
+                      && fread((genericptr_t) entno, sizeof *entno, 1,
+                               ixfile) == 1
+                      && *entno >= 0 && *entno < hdr->count);
+}
+
+static boolean
+ttix_read(
+    FILE *ixfile,
+    struct ttindexhdr *hdr,
+    long entno,
+    struct ttindexent *e)
+{
+    return (boolean) (fseek(ixfile, (long) sizeof *hdr
+                                    + entno * (long) sizeof *e, SEEK_SET) >= 0
+                      && fread((genericptr_t) e, sizeof *e, 1, ixfile) == 1);
+}
+
+static void
+ttix_add(long entno, long **list, long *listcnt, long *listsz)
+{
+    if (*listcnt == *listsz) {
+        long *newlist = (long *) alloc((unsigned) ((*listsz * 2 + 16)
+                                                   * sizeof entno));
+
+        if (*listcnt)
+            (void) memcpy((genericptr_t) newlist, (genericptr_t) *list,
+                          *listcnt * sizeof entno);
+        if (*list)
+            free((genericptr_t) *list);
+        *list = newlist;
+        *listsz = *listsz * 2 + 16;
+    }
+    (*list)[(*listcnt)++] = entno;
+}
+
+/* add the numbers of the entries matching key to *list */
+static boolean
+ttix_find(
+    FILE *ixfile,
+    struct ttindexhdr *hdr,
+    int which,
+    const char *key,
+    int uid,
+    long **list,
+    long *listcnt,
+    long *listsz)
+{
+    struct ttindexent e;
+    int order = (which == TTIX_ROLE1) ? TTIX_ROLE : which;
+    long lo, hi, mid, first, entno;
+
+    /* first entry not less than key... */
+    for (lo = 0, hi = hdr->count; lo < hi; ) {
+        mid = lo + (hi - lo) / 2;
+        if (!ttix_entno(ixfile, hdr, order, mid, &entno)
+            || !ttix_read(ixfile, hdr, entno, &e))
+            return FALSE;
+        if (ttix_cmp(&e, which, key, uid) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    first = lo;
+    /* ...and first one greater than it */
+    for (hi = hdr->count; lo < hi; ) {
+        mid = lo + (hi - lo) / 2;
+        if (!ttix_entno(ixfile, hdr, order, mid, &entno)
+            || !ttix_read(ixfile, hdr, entno, &e))
+            return FALSE;
+        if (ttix_cmp(&e, which, key, uid) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (; first < lo; ++first) {
+        if (!ttix_entno(ixfile, hdr, order, first, &entno))
+            return FALSE;
+        ttix_add(entno, list, listcnt, listsz);
+    }
+    return TRUE;
+}
+
+static int QSORTCALLBACK
+ttix_entno_cmp(const genericptr vptr1, const genericptr vptr2)
+{
+    long i1 = *(const long *) vptr1, i2 = *(const long *) vptr2;
+
+    return (i1 > i2) - (i1 < i2);
+}
+
+/*
+ * Use RECORDINDEX to find the entries that score_wanted() might pick
+ * for these arguments.  Returns how many there are, with their entry
+ * numbers (rank - 1) in order in *list and their index entries in
+ * *ents, or -1 if the index can't be used and 'record' has to be read
+ * through instead.
+ */
+static long
+ttindex_lookup(
+    FILE *rfile,
+    int playerct,
+    const char **players,
+    int uid,
+    long **list,
+    struct ttindexent **ents)
+{
+    struct ttindexhdr hdr;
+    FILE *ixfile;
+    long cnt = 0, sz = 0, i, j, n;
+    boolean ok = TRUE;
+    int k, r;
+
+    *list = (long *) 0;
+    *ents = (struct ttindexent *) 0;
+    if (!(ixfile = open_ttindex(rfile, &hdr)))
+        return -1L;
+    if (sysopt.pers_is_uid && !playerct)
+        ok = ttix_find(ixfile, &hdr, TTIX_UID, "", uid, list, &cnt, &sz);
+    /* the same cases as score_wanted() */
+    for (k = 0; ok && k < playerct; k++) {
+        if (players[k][0] == '-' && index("pr", players[k][1])
+            && players[k][2] == 0 && k + 1 < playerct) {
+            const char *arg = players[k + 1];
+
+            if (players[k][1] == 'p') {
+                if ((r = str2role(arg)) < 0)
+                    ok = FALSE;
+                else
+                    ok = ttix_find(ixfile, &hdr, TTIX_ROLE,
+                                   roles[r].filecode, 0, list, &cnt, &sz);
+            } else {
+                if ((r = str2race(arg)) < 0)
+                    ok = FALSE;
+                else
+                    ok = ttix_find(ixfile, &hdr, TTIX_RACE,
+                                   races[r].filecode, 0, list, &cnt, &sz);
+            }
+            k++;
+        } else if (strcmp(players[k], "all") == 0) {
+            ok = FALSE; /* everything; nothing to gain from the index */
+        } else {
+            ok = ttix_find(ixfile, &hdr, TTIX_NAME, players[k], 0,
+                           list, &cnt, &sz);
+            if (ok && players[k][0] == '-' && players[k][1]
+                && players[k][2] == 0)
+                ok = ttix_find(ixfile, &hdr, TTIX_ROLE1, &players[k][1], 0,
+                               list, &cnt, &sz);
+            if (ok && digit(players[k][0])) {
+                n = min((long) atoi(players[k]), hdr.count);
+                for (i = 0; i < n; ++i)
+                    ttix_add(i, list, &cnt, &sz);
+            }
+        }
+    }
+    if (ok && cnt) {
+        qsort((genericptr_t) *list, (size_t) cnt, sizeof (long),
+              ttix_entno_cmp);
+        for (i = j = 0; i < cnt; ++i)
+            if (!j || (*list)[i] != (*list)[j - 1])
+                (*list)[j++] = (*list)[i];
+        cnt = j;
+        *ents = (struct ttindexent *) alloc((unsigned) (cnt
+                                                        * sizeof **ents));
+        for (i = 0; ok && i < cnt; ++i)
+            ok = ttix_read(ixfile, &hdr, (*list)[i], &(*ents)[i]);
+    }
+    (void) fclose(ixfile);
+    if (!ok) {
+        if (*list)
+            free((genericptr_t) *list), *list = (long *) 0;
+        if (*ents)
+            free((genericptr_t) *ents), *ents = (struct ttindexent *) 0;
+        return -1L;
+    }
+    return cnt;
+}
+#endif /* RECORD_INDEX */
+
 /* throw away characters until current record has been entirely consumed */
 static void
 discardexcess(FILE* rfile)
@@ -625,8 +1078,9 @@ topten(int how, time_t when)
     int occ_cnt = sysopt.persmax;
     int flg = 0;
     boolean t0_used, skip_scores;
-
 #ifdef UPDATE_RECORD_IN_PLACE
+    long rewrite_fpos = -1L; /* where the first changed entry goes */
+
     final_fpos = 0L;
 #endif
     /* If we are in the midst of a panic, cut out topten entirely.
@@ -684,25 +1138,25 @@ topten(int how, time_t when)
 #endif
 
 #ifdef LOGFILE /* used for debugging (who dies of what, where) */
-    if (lock_file(LOGFILE, SCOREPREFIX, 10)) {
-        if (!(lfile = fopen_datafile(LOGFILE, "a", SCOREPREFIX))) {
+    if (lock_logfile(LOGFILE)) {
+        if (!(lfile = open_logfile(LOGFILE))) {
             HUP raw_print("Cannot open log file!");
         } else {
             writeentry(lfile, t0);
             (void) fclose(lfile);
         }
-        unlock_file(LOGFILE);
+        unlock_logfile(LOGFILE);
     }
 #endif /* LOGFILE */
 #ifdef XLOGFILE
-    if (lock_file(XLOGFILE, SCOREPREFIX, 10)) {
-        if (!(xlfile = fopen_datafile(XLOGFILE, "a", SCOREPREFIX))) {
+    if (lock_logfile(XLOGFILE)) {
+        if (!(xlfile = open_logfile(XLOGFILE))) {
             HUP raw_print("Cannot open extended log file!");
         } else {
             writexlentry(xlfile, t0, how);
             (void) fclose(xlfile);
         }
-        unlock_file(XLOGFILE);
+        unlock_logfile(XLOGFILE);
     }
 #endif /* XLOGFILE */
 
@@ -783,6 +1237,10 @@ topten(int how, time_t when)
                 }
             }
             if (occ_cnt < 0) {
+#ifdef UPDATE_RECORD_IN_PLACE
+                if (rewrite_fpos < 0L)
+                    rewrite_fpos = t1->fpos; /* this one is dropped */
+#endif
                 flg++;
                 continue;
             }
@@ -799,7 +1257,12 @@ topten(int how, time_t when)
     }
     if (flg) { /* rewrite record file */
 #ifdef UPDATE_RECORD_IN_PLACE
-        (void) fseek(rfile, (t0->fpos >= 0) ? t0->fpos : final_fpos, SEEK_SET);
+        /* entries before the first new or dropped one stay as they are */
+        if (t0_used && (rewrite_fpos < 0L || t0->fpos < rewrite_fpos))
+            rewrite_fpos = t0->fpos;
+        if (rewrite_fpos < 0L)
+            rewrite_fpos = final_fpos;
+        (void) fseek(rfile, rewrite_fpos, SEEK_SET);
 #else
         (void) fclose(rfile);
         if (!(rfile = fopen_datafile(RECORD, "w", SCOREPREFIX))) {
@@ -834,10 +1297,14 @@ topten(int how, time_t when)
     for (t1 = tt_head, rank = 1; t1->points != 0; t1 = t1->tt_next, ++rank) {
         if (flg
 #ifdef UPDATE_RECORD_IN_PLACE
-            && rank >= rank0
+            && t1->fpos >= rewrite_fpos
+#endif
+            ) {
+#ifdef UPDATE_RECORD_IN_PLACE
+            t1->fpos = ftell(rfile); /* where it is now */
 #endif
-            )
             writeentry(rfile, t1);
+        }
         if (skip_scores || done_stopprint)
             continue;
         if (rank <= flags.end_top
@@ -885,6 +1352,17 @@ topten(int how, time_t when)
 #endif /* TRUNCATE_FILE */
     }
 #endif /* UPDATE_RECORD_IN_PLACE */
+#ifdef RECORD_INDEX
+    {
+        struct ttindexhdr hdr;
+        FILE *ixfile = !flg ? open_ttindex(rfile, &hdr) : (FILE *) 0;
+
+        if (ixfile)
+            (void) fclose(ixfile); /* still up to date */
+        else
+            write_ttindex(rfile);
+    }
+#endif
     (void) fclose(rfile);
     unlock_file(RECORD);
     free_ttlist(tt_head);
@@ -1138,6 +1616,12 @@ prscore(int argc, char **argv)
     char pbuf[BUFSZ];
     int uid = -1;
     const char *player0;
+    int *ranks = (int *) 0; /* when only wanted entries have been read */
+#ifdef RECORD_INDEX
+    long ixcnt, *ixlist;
+    struct ttindexent *ixents;
+    int n;
+#endif
 
     if (argc < 2 || strncmp(argv[1], "-s", 2)) {
         raw_printf("prscore: bad arguments (%d)", argc);
@@ -1202,6 +1686,44 @@ prscore(int argc, char **argv)
     raw_print("");
 
     t1 = tt_head = newttentry();
+#ifdef RECORD_INDEX
+    ixcnt = ttindex_lookup(rfile, playerct, players, uid, &ixlist, &ixents);
+    if (ixcnt >= 0) {
+        /* read just the candidates; if one isn't what the index says,
+           'record' has changed since and gets read through after all */
+        ranks = (int *) alloc((unsigned) (max(ixcnt, 1) * sizeof *ranks));
+        for (i = n = 0; i < ixcnt; i++) {
+            if (fseek(rfile, ixents[i].fpos, SEEK_SET) < 0)
+                break;
+            readentry(rfile, t1);
+            if (t1->points == 0 || t1->uid != ixents[i].uid
+                || strcmp(t1->name, ixents[i].name)
+                || strcmp(t1->plrole, ixents[i].plrole)
+                || strcmp(t1->plrace, ixents[i].plrace))
+                break;
+            if (score_wanted(current_ver, (int) ixlist[i] + 1, t1, playerct,
+                             players, uid)) {
+                ranks[n++] = (int) ixlist[i] + 1;
+                t1->tt_next = newttentry();
+                t1 = t1->tt_next;
+            }
+        }
+        t1->points = 0;
+        match_found = (n > 0);
+        if (i < ixcnt) {
+            free_ttlist(tt_head);
+            free((genericptr_t) ranks), ranks = (int *) 0;
+            match_found = FALSE;
+            t1 = tt_head = newttentry();
+            rewind(rfile);
+        }
+        if (ixlist)
+            free((genericptr_t) ixlist);
+        if (ixents)
+            free((genericptr_t) ixents);
+    }
+    if (!ranks)
+#endif
     for (rank = 1;; rank++) {
         readentry(rfile, t1);
         if (t1->points == 0)
@@ -1223,7 +1745,10 @@ prscore(int argc, char **argv)
         outheader();
         t1 = tt_head;
         for (rank = 1; t1->points != 0; rank++, t1 = t1->tt_next) {
-            if (score_wanted(current_ver, rank, t1, playerct, players, uid))
+            if (ranks)
+                (void) outentry(ranks[rank - 1], t1, FALSE);
+            else if (score_wanted(current_ver, rank, t1, playerct, players,
+                                  uid))
                 (void) outentry(rank, t1, FALSE);
         }
     } else {
@@ -1260,6 +1785,8 @@ prscore(int argc, char **argv)
         raw_printf("Player types are: [-p role] [-r race]");
     }
     free_ttlist(tt_head);
+    if (ranks)
+        free((genericptr_t) ranks);
 #ifdef AMIGA
     {
         extern winid amii_rawprwin;
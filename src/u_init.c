@@ -674,11 +674,7 @@ u_init(void)
     u.ualignbase[A_CURRENT] = u.ualignbase[A_ORIGINAL] = u.ualign.type =
         aligns[flags.initalign].value;
 
-#if defined(BSD) && !defined(POSIX_TYPES)
-    (void) time((long *) &ubirthday);
-#else
-    (void) time(&ubirthday);
-#endif
+    ubirthday = getnow();
 
     /*
      *  For now, everyone starts out with a night vision range of 1 and
@@ -709,6 +705,9 @@ u_init(void)
         if (rn2(100) >= 50) { /* see above comment */
             Barbarian[B_MAJOR].trotyp = BATTLE_AXE;
             Barbarian[B_MINOR].trotyp = SHORT_SWORD;
+        } else { /* in case an earlier u_init() chose the axe */
+            Barbarian[B_MAJOR].trotyp = TWO_HANDED_SWORD;
+            Barbarian[B_MINOR].trotyp = AXE;
         }
         ini_inv(Barbarian);
         if (!rn2(6))
@@ -1002,6 +1001,8 @@ ini_inv(struct trobj *trop)
 {
     struct obj *obj;
     int otyp, i;
+    /* count down a copy so that the tables are intact for another game */
+    int trquan = trop->trquan;
 
 	while (trop->trclass) {
         otyp = (int) trop->trotyp;
@@ -1101,6 +1102,7 @@ ini_inv(struct trobj *trop)
         if (u.uroleplay.nudist && obj->oclass == ARMOR_CLASS) {
             dealloc_obj(obj);
             trop++;
+            trquan = trop->trquan;
             continue;
         }
 
@@ -1119,8 +1121,8 @@ ini_inv(struct trobj *trop)
             if (obj->opoisoned && u.ualign.type != A_CHAOTIC)
                 obj->opoisoned = 0;
             if (obj->oclass == WEAPON_CLASS || obj->oclass == TOOL_CLASS) {
-                obj->quan = (long) trop->trquan;
-                trop->trquan = 1;
+                obj->quan = (long) trquan;
+                trquan = 1;
             } else if (obj->oclass == GEM_CLASS && is_graystone(obj)
                        && obj->otyp != FLINT) {
                 obj->quan = 1L;
@@ -1176,9 +1178,10 @@ ini_inv(struct trobj *trop)
         if (obj->oclass == SPBOOK_CLASS && obj->otyp != SPE_BLANK_PAPER)
             initialspell(obj);
 
-        if (--trop->trquan)
+        if (--trquan)
             continue; /* make a similar object */
         trop++;
+        trquan = trop->trquan;
     }
 }
 
@@ -22,7 +22,7 @@ newegd(struct monst *mtmp)
     if (!mtmp->mextra)
         mtmp->mextra = newmextra();
     if (!EGD(mtmp)) {
-        EGD(mtmp) = (struct egd *) alloc(sizeof (struct egd));
+        EGD(mtmp) = (struct egd *) pool_get(POOL_EGD);
         (void) memset((genericptr_t) EGD(mtmp), 0, sizeof (struct egd));
     }
 }
@@ -31,7 +31,7 @@ void
 free_egd(struct monst *mtmp)
 {
     if (mtmp->mextra && EGD(mtmp)) {
-        free((genericptr_t) EGD(mtmp));
+        pool_put(POOL_EGD, EGD(mtmp));
         EGD(mtmp) = (struct egd *) 0;
     }
     mtmp->isgd = 0;
@@ -377,15 +377,15 @@ uptodate(NHFILE *nhfp, const char *name, unsigned long utdflags)
     char indicator;
 
     if (nhfp->structlevel) {
-        rlen = read(nhfp->fd, (genericptr_t) &indicator, sizeof indicator);
-        rlen = read(nhfp->fd, (genericptr_t) &filecmc, sizeof filecmc);
+        rlen = nhread(nhfp->fd, (genericptr_t) &indicator, sizeof indicator);
+        rlen = nhread(nhfp->fd, (genericptr_t) &filecmc, sizeof filecmc);
         if (rlen == 0)
             return FALSE;
     }
     if (cmc != filecmc)
         return FALSE;
 
-    rlen = read(nhfp->fd, (genericptr_t) &vers_info, sizeof vers_info);
+    rlen = nhread(nhfp->fd, (genericptr_t) &vers_info, sizeof vers_info);
     minit();                /* ZEROCOMP */
     if (rlen == 0) {
         if (verbose) {
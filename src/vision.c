@@ -81,6 +81,33 @@ static xchar cs_rmin1[ROWNO], cs_rmax1[ROWNO];
 
 static char viz_clear[ROWNO][COLNO]; /* vision clear/blocked map */
 static char *viz_clear_rows[ROWNO];
+/* bumped whenever viz_clear changes; 0 is never used */
+static unsigned long viz_clear_gen = 1UL;
+
+/* mon_clear_path()'s last answers, one per slot; a monster's slot is
+   picked by its m_id but the answer only depends on the end points */
+#define MON_CPATH_SLOTS 64
+static struct mon_cpath {
+    unsigned long gen; /* viz_clear_gen it is good for, 0: none */
+    xchar mx, my;      /* where the monster was */
+    xchar tx, ty;      /* where it was looking from */
+    boolean clear;     /* whether the path was clear */
+} mon_cpath[MON_CPATH_SLOTS];
+
+/* viz_clear packed into bitmaps, for ray_path() */
+#define VIZ_BITS 32 /* bits used in each unsigned long */
+#define VIZ_WORDS ((COLNO + VIZ_BITS - 1) / VIZ_BITS)
+#define VIZ_ALL 0xffffffffUL
+static unsigned long viz_clear_bits[ROWNO][VIZ_WORDS];
+#define set_clear_bit(row, col, clr)                          \
+    do {                                                      \
+        if (clr)                                              \
+            viz_clear_bits[row][(col) / VIZ_BITS] |=          \
+                1UL << ((col) % VIZ_BITS);                    \
+        else                                                  \
+            viz_clear_bits[row][(col) / VIZ_BITS] &=          \
+                ~(1UL << ((col) % VIZ_BITS));                 \
+    } while (0)
 
 static xchar left_ptrs[ROWNO][COLNO]; /* LOS algorithm helpers */
 static xchar right_ptrs[ROWNO][COLNO];
@@ -94,6 +121,9 @@ static void view_from(int, int, xchar **, xchar *, xchar *, int,
                       genericptr_t);
 static void get_unused_cs(xchar ***, xchar **, xchar **);
 static void rogue_vision(xchar **, xchar *, xchar *);
+static void ray_init(void);
+static boolean clear_span(int, int, int);
+static int ray_path(int, int, int, int);
 
 /* Macro definitions that I can't find anywhere. */
 #define sign(z) ((z) < 0 ? -1 : ((z) ? 1 : 0))
@@ -223,8 +253,17 @@ vision_reset(void)
             right_ptrs[y][i] = (COLNO - 1);
             viz_clear[y][i] = !block;
         }
+        /* and the packed copy used by ray_path() */
+        (void) memset((genericptr_t) viz_clear_bits[y], 0,
+                      sizeof viz_clear_bits[y]);
+        for (x = 0; x < COLNO; x++)
+            if (viz_clear[y][x])
+                set_clear_bit(y, x, TRUE);
     }
 
+    reset_light_footprints(); /* the level under them has changed */
+    viz_clear_gen++;
+
     iflags.vision_inited = 1; /* vision is ready */
     g.vision_full_recalc = 1;   /* we want to run vision_recalc() */
 }
@@ -819,8 +858,10 @@ void
 block_point(int x, int y)
 {
     fill_point(y, x);
+    viz_clear_gen++;
 
-    /* recalc light sources here? */
+    /* light sources which could have shone past here need redoing */
+    light_block_changed(x, y);
 
     /*
      * We have to do a full vision recalculation if we "could see" the
@@ -842,8 +883,10 @@ void
 unblock_point(int x, int y)
 {
     dig_point(y, x);
+    viz_clear_gen++;
 
-    /* recalc light sources here? */
+    /* light sources which couldn't shine past here need redoing */
+    light_block_changed(x, y);
 
     if (g.viz_array[y][x])
         g.vision_full_recalc = 1;
@@ -905,6 +948,7 @@ dig_point(int row, int col)
         return; /* already done */
 
     viz_clear[row][col] = 1;
+    set_clear_bit(row, col, TRUE);
 
     /*
      * Boundary cases first.
@@ -989,6 +1033,7 @@ fill_point(int row, int col)
         return;
 
     viz_clear[row][col] = 0;
+    set_clear_bit(row, col, FALSE);
 
     if (col == 0) {
         if (viz_clear[row][1]) { /* adjacent is clear */
@@ -1100,428 +1145,121 @@ static genericptr_t varg;
 #define is_clear(row, col) viz_clear_rows[row][col]
 
 /*
- * clear_path()         expanded into 4 macros/functions:
- *
- *      q1_path()
- *      q2_path()
- *      q3_path()
- *      q4_path()
+ * Line of sight between two points.
  *
- * "Draw" a line from the start to the given location.  Stop if we hit
- * something that blocks light.  The start and finish points themselves are
- * not checked, just the points between them.  These routines do _not_
- * expect to be called with the same starting and stopping point.
+ * A path is "drawn" with the generalized integer Bresenham's algorithm
+ * (fast line drawing) from _Procedural Elements for Computer Graphics_,
+ * by David F. Rogers.  McGraw-Hill, 1985.  It is clear if nothing
+ * between the start and finish blocks light; the start and finish points
+ * themselves are not checked.
  *
- * These routines use the generalized integer Bresenham's algorithm (fast
- * line drawing) for all quadrants.  The algorithm was taken from _Procedural
- * Elements for Computer Graphics_, by David F. Rogers.  McGraw-Hill, 1985.
- */
-#ifdef MACRO_CPATH /* quadrant calls are macros */
-
-/*
- * When called, the result is in "result".
- * The first two arguments (srow,scol) are one end of the path.  The next
- * two arguments (row,col) are the destination.  The last argument is
- * used as a C language label.  This means that it must be different
- * in each pair of calls.
- */
-
-/*
- *  Quadrant I (step < 0).
- */
-#define q1_path(srow, scol, y2, x2, label)           \
-    {                                                \
-        int dx, dy;                                  \
-        register int k, err, x, y, dxs, dys;         \
-                                                     \
-        x = (scol);                                  \
-        y = (srow);                                  \
-        dx = (x2) -x;                                \
-        dy = y - (y2);                               \
-                                                     \
-        result = 0; /* default to a blocked path */  \
-                                                     \
-        dxs = dx << 1; /* save the shifted values */ \
-        dys = dy << 1;                               \
-        if (dy > dx) {                               \
-            err = dxs - dy;                          \
-                                                     \
-            for (k = dy - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    x++;                             \
-                    err -= dys;                      \
-                }                                    \
-                y--;                                 \
-                err += dxs;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-        } else {                                     \
-            err = dys - dx;                          \
-                                                     \
-            for (k = dx - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    y--;                             \
-                    err -= dxs;                      \
-                }                                    \
-                x++;                                 \
-                err += dys;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-        }                                            \
-                                                     \
-        result = 1;                                  \
-    }
-
-/*
- * Quadrant IV (step > 0).
- */
-#define q4_path(srow, scol, y2, x2, label)           \
-    {                                                \
-        int dx, dy;                                  \
-        register int k, err, x, y, dxs, dys;         \
-                                                     \
-        x = (scol);                                  \
-        y = (srow);                                  \
-        dx = (x2) -x;                                \
-        dy = (y2) -y;                                \
-                                                     \
-        result = 0; /* default to a blocked path */  \
-                                                     \
-        dxs = dx << 1; /* save the shifted values */ \
-        dys = dy << 1;                               \
-        if (dy > dx) {                               \
-            err = dxs - dy;                          \
-                                                     \
-            for (k = dy - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    x++;                             \
-                    err -= dys;                      \
-                }                                    \
-                y++;                                 \
-                err += dxs;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-                                                     \
-        } else {                                     \
-            err = dys - dx;                          \
-                                                     \
-            for (k = dx - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    y++;                             \
-                    err -= dxs;                      \
-                }                                    \
-                x++;                                 \
-                err += dys;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-        }                                            \
-                                                     \
-        result = 1;                                  \
-    }
-
-/*
- * Quadrant II (step < 0).
- */
-#define q2_path(srow, scol, y2, x2, label)           \
-    {                                                \
-        int dx, dy;                                  \
-        register int k, err, x, y, dxs, dys;         \
-                                                     \
-        x = (scol);                                  \
-        y = (srow);                                  \
-        dx = x - (x2);                               \
-        dy = y - (y2);                               \
-                                                     \
-        result = 0; /* default to a blocked path */  \
-                                                     \
-        dxs = dx << 1; /* save the shifted values */ \
-        dys = dy << 1;                               \
-        if (dy > dx) {                               \
-            err = dxs - dy;                          \
-                                                     \
-            for (k = dy - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    x--;                             \
-                    err -= dys;                      \
-                }                                    \
-                y--;                                 \
-                err += dxs;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-        } else {                                     \
-            err = dys - dx;                          \
-                                                     \
-            for (k = dx - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    y--;                             \
-                    err -= dxs;                      \
-                }                                    \
-                x--;                                 \
-                err += dys;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-        }                                            \
-                                                     \
-        result = 1;                                  \
-    }
-
-/*
- * Quadrant III (step > 0).
- */
-#define q3_path(srow, scol, y2, x2, label)           \
-    {                                                \
-        int dx, dy;                                  \
-        register int k, err, x, y, dxs, dys;         \
-                                                     \
-        x = (scol);                                  \
-        y = (srow);                                  \
-        dx = x - (x2);                               \
-        dy = (y2) -y;                                \
-                                                     \
-        result = 0; /* default to a blocked path */  \
-                                                     \
-        dxs = dx << 1; /* save the shifted values */ \
-        dys = dy << 1;                               \
-        if (dy > dx) {                               \
-            err = dxs - dy;                          \
-                                                     \
-            for (k = dy - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    x--;                             \
-                    err -= dys;                      \
-                }                                    \
-                y++;                                 \
-                err += dxs;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-                                                     \
-        } else {                                     \
-            err = dys - dx;                          \
-                                                     \
-            for (k = dx - 1; k; k--) {               \
-                if (err >= 0) {                      \
-                    y++;                             \
-                    err -= dxs;                      \
-                }                                    \
-                x--;                                 \
-                err += dys;                          \
-                if (!is_clear(y, x))                 \
-                    goto label; /* blocked */        \
-            }                                        \
-        }                                            \
-                                                     \
-        result = 1;                                  \
-    }
-
-#else /* !MACRO_CPATH -- quadrants are really functions */
-
-static int _q1_path(int, int, int, int);
-static int _q2_path(int, int, int, int);
-static int _q3_path(int, int, int, int);
-static int _q4_path(int, int, int, int);
-
-#define q1_path(sy, sx, y, x, dummy) result = _q1_path(sy, sx, y, x)
-#define q2_path(sy, sx, y, x, dummy) result = _q2_path(sy, sx, y, x)
-#define q3_path(sy, sx, y, x, dummy) result = _q3_path(sy, sx, y, x)
-#define q4_path(sy, sx, y, x, dummy) result = _q4_path(sy, sx, y, x)
-
-/*
- * Quadrant I (step < 0).
+ * Which points are between only depends on the offset from the start to
+ * the finish, and the lines for the other three quadrants are mirror
+ * images of the ones for quadrant IV (down and to the right).  So
+ * ray_init() draws the quadrant IV line for every offset on the map once
+ * and records it as the span of columns it crosses in each row.  A path
+ * is then checked a row at a time against viz_clear_bits, which is
+ * viz_clear packed into bitmaps, a word of columns at a time.
  */
-static int
-_q1_path(int scol, int srow, int y2, int x2)
-{
-    int dx, dy;
-    register int k, err, x, y, dxs, dys;
-
-    x = scol;
-    y = srow;
-    dx = x2 - x;
-    dy = y - y2;
-
-    dxs = dx << 1; /* save the shifted values */
-    dys = dy << 1;
-    if (dy > dx) {
-        err = dxs - dy;
-
-        for (k = dy - 1; k; k--) {
-            if (err >= 0) {
-                x++;
-                err -= dys;
-            }
-            y--;
-            err += dxs;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
-        }
-    } else {
-        err = dys - dx;
-
-        for (k = dx - 1; k; k--) {
-            if (err >= 0) {
-                y--;
-                err -= dxs;
-            }
-            x++;
-            err += dys;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
-        }
-    }
+struct ray_span {
+    xchar lo, hi; /* columns crossed in one row, relative to the start */
+};
+struct ray {
+    int first;          /* first span, in ray_spans[] */
+    xchar row0, nrows;  /* relative row of first span, number of spans */
+};
 
-    return 1;
-}
+static struct ray rays[ROWNO][COLNO];               /* [dy][dx] */
+static struct ray_span ray_spans[ROWNO * (ROWNO + 1) / 2 * COLNO];
 
-/*
- * Quadrant IV (step > 0).
- */
-static int
-_q4_path(int scol, int srow, int y2, int x2)
+/* draw the quadrant IV line for every offset */
+static void
+ray_init(void)
 {
-    int dx, dy;
-    register int k, err, x, y, dxs, dys;
-
-    x = scol;
-    y = srow;
-    dx = x2 - x;
-    dy = y2 - y;
-
-    dxs = dx << 1; /* save the shifted values */
-    dys = dy << 1;
-    if (dy > dx) {
-        err = dxs - dy;
-
-        for (k = dy - 1; k; k--) {
-            if (err >= 0) {
-                x++;
-                err -= dys;
-            }
-            y++;
-            err += dxs;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
-        }
-    } else {
-        err = dys - dx;
-
-        for (k = dx - 1; k; k--) {
-            if (err >= 0) {
-                y++;
-                err -= dxs;
+    int ddx, ddy, dx, dy, k, err, x, y, dxs, dys, n = 0;
+    struct ray *ray;
+    struct ray_span *span = 0;
+
+    for (ddy = 0; ddy < ROWNO; ddy++)
+        for (ddx = 0; ddx < COLNO; ddx++) {
+            ray = &rays[ddy][ddx];
+            ray->first = n;
+            ray->row0 = ray->nrows = 0;
+
+            x = y = 0;
+            dx = ddx;
+            dy = ddy;
+            dxs = dx << 1; /* save the shifted values */
+            dys = dy << 1;
+            err = (dy > dx) ? dxs - dy : dys - dx;
+            for (k = ((dy > dx) ? dy : dx) - 1; k > 0; k--) {
+                if (dy > dx) {
+                    if (err >= 0) {
+                        x++;
+                        err -= dys;
+                    }
+                    y++;
+                    err += dxs;
+                } else {
+                    if (err >= 0) {
+                        y++;
+                        err -= dxs;
+                    }
+                    x++;
+                    err += dys;
+                }
+                /* (x,y) would be checked; x and y never go down */
+                if (!ray->nrows || y != ray->row0 + ray->nrows - 1) {
+                    if (!ray->nrows)
+                        ray->row0 = y;
+                    ray->nrows++;
+                    span = &ray_spans[n++];
+                    span->lo = x;
+                }
+                span->hi = x;
             }
-            x++;
-            err += dys;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
         }
-    }
-
-    return 1;
 }
 
-/*
- * Quadrant II (step < 0).
- */
-static int
-_q2_path(int scol, int srow, int y2, int x2)
+/* are columns lo through hi of row all clear? */
+static boolean
+clear_span(int row, int lo, int hi)
 {
-    int dx, dy;
-    register int k, err, x, y, dxs, dys;
-
-    x = scol;
-    y = srow;
-    dx = x - x2;
-    dy = y - y2;
-
-    dxs = dx << 1; /* save the shifted values */
-    dys = dy << 1;
-    if (dy > dx) {
-        err = dxs - dy;
-
-        for (k = dy - 1; k; k--) {
-            if (err >= 0) {
-                x--;
-                err -= dys;
-            }
-            y--;
-            err += dxs;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
-        }
-    } else {
-        err = dys - dx;
-
-        for (k = dx - 1; k; k--) {
-            if (err >= 0) {
-                y--;
-                err -= dxs;
-            }
-            x--;
-            err += dys;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
-        }
-    }
-
-    return 1;
+    const unsigned long *bits = viz_clear_bits[row];
+    int w = lo / VIZ_BITS, last = hi / VIZ_BITS;
+    unsigned long mask = (VIZ_ALL << (lo % VIZ_BITS)) & VIZ_ALL;
+
+    for (; w < last; w++, mask = VIZ_ALL)
+        if ((bits[w] & mask) != mask)
+            return FALSE;
+    mask &= VIZ_ALL >> (VIZ_BITS - 1 - hi % VIZ_BITS);
+    return (boolean) ((bits[last] & mask) == mask);
 }
 
 /*
- * Quadrant III (step > 0).
+ * Is there nothing blocking light between (scol,srow) and (col,row)?
+ * Returns 1 for a clear path.  Don't call with the same starting and
+ * stopping point.
  */
 static int
-_q3_path(int scol, int srow, int y2, int x2)
+ray_path(int srow, int scol, int row, int col)
 {
-    int dx, dy;
-    register int k, err, x, y, dxs, dys;
-
-    x = scol;
-    y = srow;
-    dx = x - x2;
-    dy = y2 - y;
-
-    dxs = dx << 1; /* save the shifted values */
-    dys = dy << 1;
-    if (dy > dx) {
-        err = dxs - dy;
-
-        for (k = dy - 1; k; k--) {
-            if (err >= 0) {
-                x--;
-                err -= dys;
-            }
-            y++;
-            err += dxs;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
-        }
-    } else {
-        err = dys - dx;
-
-        for (k = dx - 1; k; k--) {
-            if (err >= 0) {
-                y++;
-                err -= dxs;
-            }
-            x--;
-            err += dys;
-            if (!is_clear(y, x))
-                return 0; /* blocked */
-        }
+    int dx = col - scol, dy = row - srow, i, r, lo, hi;
+    const struct ray *ray = &rays[v_abs(dy)][v_abs(dx)];
+    const struct ray_span *span = &ray_spans[ray->first];
+
+    for (i = 0; i < ray->nrows; i++, span++) {
+        r = (dy < 0) ? srow - ray->row0 - i : srow + ray->row0 + i;
+        if (dx < 0)
+            lo = scol - span->hi, hi = scol - span->lo;
+        else
+            lo = scol + span->lo, hi = scol + span->hi;
+        if (!clear_span(r, lo, hi))
+            return 0; /* blocked */
     }
-
     return 1;
 }
 
-#endif /* ?MACRO_CPATH */
-
 /*
  * Use vision tables to determine if there is a clear path from
  * (col1,row1) to (col2,row2).  This is used by:
@@ -1532,27 +1270,31 @@ _q3_path(int scol, int srow, int y2, int x2)
 boolean
 clear_path(int col1, int row1, int col2, int row2)
 {
-    int result;
+    if (row1 == row2 && col1 == col2)
+        return TRUE;
+    return (boolean) ray_path(row1, col1, row2, col2);
+}
 
-    if (col1 < col2) {
-        if (row1 > row2) {
-            q1_path(row1, col1, row2, col2, cleardone);
-        } else {
-            q4_path(row1, col1, row2, col2, cleardone);
-        }
-    } else {
-        if (row1 > row2) {
-            q2_path(row1, col1, row2, col2, cleardone);
-        } else if (row1 == row2 && col1 == col2) {
-            result = 1;
-        } else {
-            q3_path(row1, col1, row2, col2, cleardone);
-        }
+/*
+ * clear_path() from (x,y) to the monster's location.  Monsters deciding
+ * whether they are lined up with the hero ask this several times a move,
+ * so the last answer is kept, in a table rather than in the monster so
+ * that it isn't saved, and reused until either end moves or something
+ * starts or stops blocking light.
+ */
+boolean
+mon_clear_path(struct monst *mon, int x, int y)
+{
+    struct mon_cpath *mc = &mon_cpath[mon->m_id % MON_CPATH_SLOTS];
+
+    if (mc->gen != viz_clear_gen || mc->mx != mon->mx || mc->my != mon->my
+        || mc->tx != x || mc->ty != y) {
+        mc->clear = clear_path(x, y, mon->mx, mon->my);
+        mc->gen = viz_clear_gen;
+        mc->mx = mon->mx, mc->my = mon->my;
+        mc->tx = x, mc->ty = y;
     }
-#ifdef MACRO_CPATH
-cleardone:
-#endif
-    return (boolean) result;
+    return mc->clear;
 }
 
 /*==========================================================================*\
@@ -1566,10 +1308,11 @@ cleardone:
 static void right_side(int, int, int, const xchar *);
 static void left_side(int, int, int, const xchar *);
 
-/* Initialize algorithm C (nothing). */
+/* Initialize algorithm C. */
 static void
 view_init(void)
 {
+    ray_init();
 }
 
 /*
@@ -1589,7 +1332,7 @@ right_side(int row, int left, int right_mark, const xchar *limits)
     int right_edge;             /* right edge of an opening */
     int nrow;                   /* new row (calculate once) */
     int deeper;                 /* if TRUE, call self as needed */
-    int result;                 /* set by q?_path() */
+    int result;                 /* set by ray_path() */
     register int i;             /* loop counter */
     register xchar *rowp = NULL; /* row optimization */
     xchar *row_min = NULL;       /* left most  [used by macro set_min()] */
@@ -1663,12 +1406,7 @@ right_side(int row, int left, int right_mark, const xchar *limits)
              * into a wall.
              */
             for (; left <= right_edge; left++) {
-                if (step < 0) {
-                    q1_path(start_row, start_col, row, left, rside1);
-                } else {
-                    q4_path(start_row, start_col, row, left, rside1);
-                }
-            rside1: /* used if q?_path() is a macro */
+                result = ray_path(start_row, start_col, row, left);
                 if (result)
                     break;
             }
@@ -1717,12 +1455,7 @@ right_side(int row, int left, int right_mark, const xchar *limits)
          */
         if (right_mark < right_edge) {
             for (right = right_mark; right <= right_edge; right++) {
-                if (step < 0) {
-                    q1_path(start_row, start_col, row, right, rside2);
-                } else {
-                    q4_path(start_row, start_col, row, right, rside2);
-                }
-            rside2: /* used if q?_path() is a macro */
+                result = ray_path(start_row, start_col, row, right);
                 if (!result)
                     break;
             }
@@ -1828,12 +1561,7 @@ left_side(int row, int left_mark, int right, const xchar *limits)
         if (right != start_col) {
             /* Find the right side. */
             for (; right >= left_edge; right--) {
-                if (step < 0) {
-                    q2_path(start_row, start_col, row, right, lside1);
-                } else {
-                    q3_path(start_row, start_col, row, right, lside1);
-                }
-            lside1: /* used if q?_path() is a macro */
+                result = ray_path(start_row, start_col, row, right);
                 if (result)
                     break;
             }
@@ -1860,12 +1588,7 @@ left_side(int row, int left_mark, int right, const xchar *limits)
         /* Find the left side. */
         if (left_mark > left_edge) {
             for (left = left_mark; left >= left_edge; --left) {
-                if (step < 0) {
-                    q2_path(start_row, start_col, row, left, lside2);
-                } else {
-                    q3_path(start_row, start_col, row, left, lside2);
-                }
-            lside2: /* used if q?_path() is a macro */
+                result = ray_path(start_row, start_col, row, left);
                 if (!result)
                     break;
             }
@@ -203,6 +203,19 @@ genl_can_suspend_yes(void)
     return TRUE;
 }
 
+/* for window ports without a print_glyph_run() of their own:  print the
+   run of 'count' glyphs starting at <x,y> one at a time */
+void
+genl_print_glyph_run(winid window, xchar x, xchar y, int count,
+                     const glyph_info *glyphinfo,
+                     const glyph_info *bkglyphinfo)
+{
+    int i;
+
+    for (i = 0; i < count; ++i)
+        print_glyph(window, x + i, y, &glyphinfo[i], &bkglyphinfo[i]);
+}
+
 static
 void
 def_raw_print(const char *s)
@@ -560,7 +573,7 @@ static struct window_procs hup_procs = {
 #ifdef POSITIONBAR
     (void (*)(char *)) hup_void_fdecl_constchar_p,    /* update_positionbar */
 #endif
-    hup_print_glyph,
+    hup_print_glyph, genl_print_glyph_run,
     hup_void_fdecl_constchar_p,                       /* raw_print */
     hup_void_fdecl_constchar_p,                       /* raw_print_bold */
     hup_nhgetch, hup_nh_poskey, hup_void_ndecl,       /* nhbell  */
@@ -4844,7 +4844,7 @@ fracture_rock(struct obj *obj) /* no texts here! */
         sokoban_guilt();
 
     obj->otyp = ROCK;
-    obj->oclass = GEM_CLASS;
+    set_obj_class(obj, GEM_CLASS);
     obj->quan = (long) rn1(60, 7);
     obj->owt = weight(obj);
     obj->dknown = obj->bknown = obj->rknown = 0;
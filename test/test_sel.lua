@@ -60,6 +60,9 @@ function test_selection_params()
 
    sel:set(1, 2);
    sel_pt_ne(sel, 1,2, 1, "test_selection_params 2");
+   if sel:numpoints() ~= 1 then
+      error("sel:numpoints returned " .. sel:numpoints() .. ", wanted 1");
+   end
 
    local x,y = sel:rndcoord(1);
    if x ~= 1 or y ~= 2 then
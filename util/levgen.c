@@ -0,0 +1,1009 @@
+/* NetHack 3.7	levgen.c	$NHDT-Date$  $NHDT-Branch: NetHack-3.7 $:$NHDT-Revision$ */
+/* NetHack may be freely redistributed.  See license for details. */
+
+/*
+ * levgen - headless batch level generator.
+ *
+ * Links against libnh.a (the game core plus the shim window port, built
+ * with WANT_LIBNH) and, for each seed in the requested range, seeds the
+ * core RNG, sets up a new character the way newgame() does and then
+ * creates the requested levels with mklev(), writing a compact text
+ * description of each one.  Game state is torn down with freedynamicdata()
+ * and rebuilt between seeds, so one process can handle any number of them.
+ *
+ * With -j, a supervisor forks that many workers instead (-j 0 means one
+ * per online cpu).  The globals in `g' rule out threads, but each forked
+ * worker has its own copy of everything.  Workers claim chunks of seeds
+ * from a queue in shared memory, and once the queue runs dry, an idle
+ * worker steals the unstarted half of the biggest chunk still held by
+ * another one, so a few seeds that hit expensive levels don't leave the
+ * rest of the workers idle.  Each seed's output goes through a ring of
+ * shared-memory slots indexed by seed, which the supervisor drains in seed
+ * order; the merged output is identical to that of a single process.
+ *
+ * With -q, the named lua file is run once per process and has to return
+ * a predicate function.  That is called after each level is made, with
+ * the usual nh, obj and selection bindings (nh.getmap(), obj.at(), ...)
+ * looking at the new level and a table argument
+ *      { seed, dungeon, dnum, dlevel, depth, special, last, rooms }
+ * where special is the special level's name if any, last is true for the
+ * seed's final level and rooms lists { lx, ly, hx, hy, rtype, rlit }.  A
+ * false or nil result rejects the seed on the spot: its remaining levels
+ * are never made and nothing is written for it.  The lua state persists,
+ * so a query can remember earlier levels of a seed and decide on the last
+ * one.  It must not use the random number functions; that would change
+ * the levels which follow.
+ *
+ * Levels are generated one after another right after u_init(), so the
+ * layout for a given seed matches the real game only for the first level
+ * generated; later ones see a different RNG state than a player who
+ * actually walked there would.
+ *
+ * With -w, the hero and a pet are then put on each level and left to it
+ * for the given number of turns:  the hero travels from one staircase to
+ * the next, searching whenever it can't get anywhere, while the monsters
+ * take their moves, and the level is described a second time, after a
+ * W line.  This is a stripped down moveloop() (no hunger, prayer timeout,
+ * spell aging and so forth, and the hero doesn't leave the level), but it
+ * runs monster and pet movement, item pickup and travel the way the game
+ * does, so the same seeds give the same results from one build to the
+ * next unless one of those has changed its behavior.  The game's clock
+ * is stopped at noon (LGNOW), so the time of day doesn't matter either.
+ * As with the fuzzer, the hero is saved from death, impossible() becomes
+ * a panic and sanity_check() is run every turn.
+ *
+ * Output, one record per seed and level:
+ *      S seed dungeon-name dlevel depth special-level-name|-
+ *      M <COLNO map characters>                (ROWNO lines, row 0 first)
+ *      T x y u|d s|l dnum:dlevel               (stairs and ladders)
+ *      R lx ly hx hy rtype rlit                (rooms)
+ *      O x y otyp quan name                    (objects on the floor)
+ *      N x y mndx name                         (monsters)
+ *      E
+ * and with -w, for each level after walking
+ *      W moves ux uy uhp
+ * followed by a second S ... E record.
+ */
+
+#include "hack.h"
+#include "dlb.h"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#ifndef USE_ISAAC64
+#error "levgen needs USE_ISAAC64 to produce reproducible levels"
+#endif
+
+/* one entry of the -l level list; resolved against each seed's dungeon
+   layout since special level placement varies from game to game */
+struct lgspec {
+    char dname[BUFSZ]; /* dungeon name, or empty for the Dungeons of Doom */
+    char special[BUFSZ]; /* special level prototype name, or empty */
+    int lo, hi;          /* level range within the dungeon */
+};
+
+/* seeds given on the command line; seed "indices" count across all of
+   them in order and are what the farm hands out and merges by */
+struct lgrange {
+    unsigned long lo, hi;
+};
+
+#define LGMAXWORKERS 256
+#define LGSLOTS_PER_WORKER 16
+#define LGMAXCHUNK 8 /* most seeds claimed from the queue at once */
+/* generous guess at the output for one level, used to size ring slots */
+#define LGLEVELSZ (ROWNO * (COLNO + 3) + 2 * BUFSZ * 4)
+#define LGMAXRING (64L * 1024L * 1024L) /* shrink slot count beyond this */
+/* noon, 1 Jan 2020 UTC:  what the game sees as the time, so that night()
+   and midnight() don't make the output depend on when levgen is run */
+#define LGNOW ((time_t) 1577880000L)
+
+/* one slot of the result ring; slot i carries seeds i, i + nslots, ... */
+struct lgslot {
+    unsigned long idx; /* seed index allowed to use the slot next */
+    boolean full;      /* data[] holds len bytes of idx's output */
+    boolean more;      /* and more of the same seed's output follows */
+    size_t len;
+    char data[1];      /* really farm->slotsz bytes; bigger outputs are
+                          passed through the slot in pieces */
+};
+
+/* seed indices [next, end) are claimed by a worker but not started yet */
+struct lgworker {
+    unsigned long next, end;
+};
+
+/* everything the supervisor and workers share; one lock guards all of it
+   except slot data, which only the slot's current owner touches */
+struct lgfarm {
+    pthread_mutex_t lock;
+    pthread_cond_t changed; /* broadcast on every slot or queue change */
+    unsigned long queued;   /* first seed index nobody has claimed */
+    pid_t supervisor;
+    int nworkers, nslots;
+    size_t slotsz, slotstride;
+    struct lgworker w[LGMAXWORKERS];
+    /* nslots struct lgslot's of slotstride bytes each follow */
+};
+
+#define LGSLOT(i) \
+    ((struct lgslot *) ((char *) (farm + 1) + (i) * farm->slotstride))
+
+static void usage(void) NORETURN;
+static void lg_printf(const char *, ...) PRINTF_F(1, 2);
+static unsigned long seed_at(unsigned long);
+static void run_serial(void);
+static void run_farm(int);
+static void farm_worker(int);
+static boolean farm_claim(struct lgworker *);
+static void farm_put(unsigned long);
+static void farm_check_workers(pid_t *);
+static boolean parse_range(const char *, unsigned long *, unsigned long *);
+static void parse_levels(const char *);
+static void levgen_init(const char *);
+static void levgen_reset(void);
+static int levgen_targets(unsigned long, d_level *);
+static void levgen_seed(unsigned long);
+static void query_init(const char *);
+static int query_traceback(lua_State *);
+static boolean levgen_query(unsigned long, boolean);
+static void levgen_level(unsigned long, d_level *);
+static void levgen_describe(unsigned long);
+static void levgen_walk(unsigned long);
+static int lgspec_dnum(const char *);
+static int lgspec_maxlevels(void);
+
+static const char *progname = "levgen";
+static const char *hackdir;
+static FILE *outfp;
+static char *obuf;              /* output for the seed being generated */
+static size_t olen, osize;
+static struct lgrange *ranges;
+static int nranges;
+static unsigned long nseeds;
+static struct lgfarm *farm;
+static const char *queryfile;
+static lua_State *queryL;       /* lives across game resets */
+static int query_ref = LUA_NOREF; /* the query's predicate function */
+static struct lgspec *lgspecs;
+static int nlgspecs;
+static boolean first_seed = TRUE;
+static boolean level_made; /* a level from this seed is still in memory */
+static long walkturns;     /* -w */
+
+static void
+usage(void)
+{
+    (void) fprintf(stderr, "Usage: %s [-d hackdir] [-o outfile] [-j workers]"
+                           " [-l levels] [-q query.lua] [-w turns]"
+                           " seed[-seed]...\n",
+                   progname);
+    (void) fprintf(stderr,
+                   "  levels is a comma separated list of N, N-M, "
+                   "dungeon:N[-M] or special level names;\n"
+                   "  the default is level 1 of the Dungeons of Doom;\n"
+                   "  -j 0 runs one worker process per cpu;\n"
+                   "  -q only describes seeds the query accepts;\n"
+                   "  -w plays each level for that many turns and"
+                   " describes it again\n");
+    exit(EXIT_FAILURE);
+    /*NOTREACHED*/
+}
+
+/* "N" or "N-M" */
+static boolean
+parse_range(const char *str, unsigned long *lo, unsigned long *hi)
+{
+    char *end;
+
+    if (!digit(*str))
+        return FALSE;
+    *lo = *hi = strtoul(str, &end, 10);
+    if (*end == '-') {
+        if (!digit(end[1]))
+            return FALSE;
+        *hi = strtoul(end + 1, &end, 10);
+    }
+    return (*end == '\0' && *lo <= *hi);
+}
+
+static void
+parse_levels(const char *arg)
+{
+    char buf[BUFSZ], *tok, *colon;
+    unsigned long lo, hi;
+    struct lgspec *spec;
+
+    (void) strncpy(buf, arg, sizeof buf - 1);
+    buf[sizeof buf - 1] = '\0';
+    for (tok = strtok(buf, ","); tok; tok = strtok((char *) 0, ",")) {
+        lgspecs = (struct lgspec *) realloc((genericptr_t) lgspecs,
+                                            (nlgspecs + 1) * sizeof *lgspecs);
+        if (!lgspecs)
+            panic("%s: out of memory", progname);
+        spec = &lgspecs[nlgspecs++];
+        (void) memset((genericptr_t) spec, 0, sizeof *spec);
+        if ((colon = index(tok, ':')) != 0) {
+            *colon++ = '\0';
+            Strcpy(spec->dname, tok);
+            tok = colon;
+        }
+        if (parse_range(tok, &lo, &hi)) {
+            spec->lo = (int) lo;
+            spec->hi = (int) hi;
+        } else if (!*spec->dname && *tok) {
+            Strcpy(spec->special, tok);
+        } else {
+            (void) fprintf(stderr, "%s: bad level \"%s\"\n", progname, arg);
+            usage();
+        }
+    }
+}
+
+/* dungeon number for a -l dungeon name; the leading "The " is optional */
+static int
+lgspec_dnum(const char *name)
+{
+    int i;
+    const char *dnam;
+
+    if (!*name)
+        return 0;
+    for (i = 0; i < g.n_dgns; i++) {
+        dnam = g.dungeons[i].dname;
+        if (!strcmpi(dnam, name)
+            || (!strncmpi(dnam, "The ", 4) && !strcmpi(dnam + 4, name)))
+            return i;
+    }
+    return -1;
+}
+
+/* most levels any one seed can ask for */
+static int
+lgspec_maxlevels(void)
+{
+    int i, n = 0;
+
+    if (!nlgspecs)
+        return 1;
+    for (i = 0; i < nlgspecs; i++)
+        n += *lgspecs[i].special ? 1
+                 : min(lgspecs[i].hi - lgspecs[i].lo + 1, MAXLEVEL);
+    return n;
+}
+
+/* once-only setup, done before the first seed */
+static void
+levgen_init(const char *dir)
+{
+    early_init();
+    g.hackpid = getpid();
+    if (dir && chdir(dir) < 0) {
+        perror(dir);
+        exit(EXIT_FAILURE);
+    }
+    choose_windows(DEFAULT_WINDOW_SYS);
+    initoptions();
+    init_nhwindows((int *) 0, (char **) 0);
+    if (!dlb_init()) {
+        (void) fprintf(stderr, "%s: can't open the data library\n", progname);
+        exit(EXIT_FAILURE);
+    }
+    if (queryfile)
+        query_init(queryfile);
+}
+
+/* throw away the previous seed's game and start over with fresh globals;
+   the shared Lua state is game independent so it is kept across the reset
+   instead of being rebuilt every time */
+static void
+levgen_reset(void)
+{
+    genericptr_t luacore = g.luacore;
+    char *luacore_nhlib = g.luacore_nhlib;
+    size_t luacore_nhlib_len = g.luacore_nhlib_len;
+
+    if (first_seed) {
+        first_seed = FALSE;
+    } else {
+        g.luacore = (genericptr_t) 0, g.luacore_nhlib = (char *) 0;
+        freedynamicdata();
+        early_init();
+        g.hackpid = getpid();
+        initoptions();
+        g.luacore = luacore;
+        g.luacore_nhlib = luacore_nhlib;
+        g.luacore_nhlib_len = luacore_nhlib_len;
+    }
+    level_made = FALSE;
+    /* no bones and no reseeding from /dev/random behind our back */
+    flags.bones = FALSE;
+    has_strong_rngseed = FALSE;
+    Strcpy(g.plname, "levgen");
+    u.uhp = 1; /* prevent RIP on early quits */
+    iflags.fixed_now = LGNOW;
+    vision_init();
+    /* u_init() reassesses the status fields, which needs them set up */
+    display_gamewindows();
+}
+
+/* collect the levels the -l list asks for, in order, for the current
+   game's dungeon layout */
+static int
+levgen_targets(unsigned long seed, d_level *targets)
+{
+    int i, lev, lo, hi, dnum, n = 0;
+    s_level *sp;
+
+    if (!nlgspecs) {
+        targets[n].dnum = 0, targets[n++].dlevel = 1;
+        return n;
+    }
+    for (i = 0; i < nlgspecs; i++) {
+        if (*lgspecs[i].special) {
+            if (!(sp = find_level(lgspecs[i].special))) {
+                (void) fprintf(stderr, "%s: seed %lu: no level \"%s\"\n",
+                               progname, seed, lgspecs[i].special);
+                continue;
+            }
+            targets[n++] = sp->dlevel;
+            continue;
+        }
+        if ((dnum = lgspec_dnum(lgspecs[i].dname)) < 0) {
+            (void) fprintf(stderr, "%s: no dungeon \"%s\"\n", progname,
+                           lgspecs[i].dname);
+            continue;
+        }
+        lo = max(lgspecs[i].lo, 1);
+        hi = min(lgspecs[i].hi, (int) g.dungeons[dnum].num_dunlevs);
+        for (lev = lo; lev <= hi; lev++)
+            targets[n].dnum = (xchar) dnum, targets[n++].dlevel = (xchar) lev;
+    }
+    return n;
+}
+
+/* generate and describe all of a seed's levels; with a query, stop at the
+   first level it rejects and throw away what was written for the seed */
+static void
+levgen_seed(unsigned long seed)
+{
+    static d_level *targets = (d_level *) 0;
+    int i, n;
+
+    if (!targets)
+        targets = (d_level *) alloc((unsigned) (lgspec_maxlevels()
+                                                * sizeof *targets));
+    levgen_reset();
+    init_isaac64(seed, rn2);
+    init_isaac64(seed, rn2_on_display_rng);
+    newgame_setup();
+
+    n = levgen_targets(seed, targets);
+    for (i = 0; i < n; i++) {
+        levgen_level(seed, &targets[i]);
+        if (query_ref != LUA_NOREF && !levgen_query(seed, i == n - 1)) {
+            olen = 0;
+            return;
+        }
+        if (walkturns > 0L)
+            levgen_walk(seed);
+    }
+}
+
+/* create one level and describe it; the previous level, if any, is
+   discarded first just as goto_level() would, minus the level file */
+static void
+levgen_level(unsigned long seed, d_level *target)
+{
+    NHFILE tnhfp;
+
+    if (level_made) {
+        /* a FREEING-only savelev() leaves dead monsters to the caller */
+        dmonsfree();
+        zero_nhfile(&tnhfp);
+        tnhfp.mode = FREEING;
+        savelev(&tnhfp, -1);
+    }
+    assign_level(&u.uz0, &u.uz);
+    assign_level(&u.uz, target);
+    /* every level is made on turn 1; don't let rndmonst() go on using
+       the previous one's alignment the way it would within one turn */
+    g.rndmonst_cache.align_moves = 0L;
+    mklev();
+    level_made = TRUE;
+    levgen_describe(seed);
+}
+
+static int
+query_traceback(lua_State *L)
+{
+    luaL_traceback(L, L, lua_tostring(L, 1), 1);
+    return 1;
+}
+
+/* load the -q script, which has to return the predicate function */
+static void
+query_init(const char *fname)
+{
+    if (!(queryL = nhl_init())) {
+        (void) fprintf(stderr, "%s: can't set up lua\n", progname);
+        exit(EXIT_FAILURE);
+    }
+    lua_pushcfunction(queryL, query_traceback);
+    if (luaL_loadfile(queryL, fname) != LUA_OK
+        || lua_pcall(queryL, 0, 1, 1) != LUA_OK) {
+        (void) fprintf(stderr, "%s: %s\n", progname,
+                       lua_tostring(queryL, -1));
+        exit(EXIT_FAILURE);
+    }
+    if (!lua_isfunction(queryL, -1)) {
+        (void) fprintf(stderr, "%s: %s did not return a function\n",
+                       progname, fname);
+        exit(EXIT_FAILURE);
+    }
+    query_ref = luaL_ref(queryL, LUA_REGISTRYINDEX);
+    lua_settop(queryL, 0);
+    iflags.in_lua = FALSE;
+}
+
+/* run the query's predicate on the level just made; FALSE rejects the
+   whole seed */
+static boolean
+levgen_query(unsigned long seed, boolean last)
+{
+    lua_State *L = queryL;
+    s_level *sp = Is_special(&u.uz);
+    struct mkroom *croom;
+    boolean ok;
+    int i;
+
+    lua_pushcfunction(L, query_traceback);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, query_ref);
+    lua_newtable(L);
+    lua_pushinteger(L, (lua_Integer) seed);
+    lua_setfield(L, -2, "seed");
+    nhl_add_table_entry_str(L, "dungeon", g.dungeons[u.uz.dnum].dname);
+    nhl_add_table_entry_int(L, "dnum", u.uz.dnum);
+    nhl_add_table_entry_int(L, "dlevel", u.uz.dlevel);
+    nhl_add_table_entry_int(L, "depth", depth(&u.uz));
+    if (sp)
+        nhl_add_table_entry_str(L, "special", sp->proto);
+    lua_pushboolean(L, last);
+    lua_setfield(L, -2, "last");
+    lua_newtable(L);
+    for (i = 0; i < g.nroom; i++) {
+        croom = &g.rooms[i];
+        lua_newtable(L);
+        nhl_add_table_entry_int(L, "lx", croom->lx);
+        nhl_add_table_entry_int(L, "ly", croom->ly);
+        nhl_add_table_entry_int(L, "hx", croom->hx);
+        nhl_add_table_entry_int(L, "hy", croom->hy);
+        nhl_add_table_entry_int(L, "rtype", croom->rtype);
+        nhl_add_table_entry_int(L, "rlit", croom->rlit);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_setfield(L, -2, "rooms");
+
+    iflags.in_lua = TRUE;
+    if (lua_pcall(L, 1, 1, 1) != LUA_OK) {
+        (void) fprintf(stderr, "%s: seed %lu: %s\n", progname, seed,
+                       lua_tostring(L, -1));
+        exit(EXIT_FAILURE);
+    }
+    iflags.in_lua = FALSE;
+    ok = lua_toboolean(L, -1) ? TRUE : FALSE;
+    lua_settop(L, 0);
+    return ok;
+}
+
+static void
+levgen_describe(unsigned long seed)
+{
+    char row[COLNO + 1];
+    int x, y, i;
+    s_level *sp = Is_special(&u.uz);
+    stairway *stway;
+    struct mkroom *croom;
+    struct obj *otmp;
+    struct monst *mtmp;
+
+    lg_printf("S %lu %s %d %d %s\n", seed, g.dungeons[u.uz.dnum].dname,
+              u.uz.dlevel, depth(&u.uz), sp ? sp->proto : "-");
+    for (y = 0; y < ROWNO; y++) {
+        for (x = 0; x < COLNO; x++)
+            row[x] = splev_typ2chr(levl[x][y].typ);
+        row[COLNO] = '\0';
+        lg_printf("M %s\n", row);
+    }
+    for (stway = g.stairs; stway; stway = stway->next)
+        lg_printf("T %d %d %c %c %d:%d\n", stway->sx, stway->sy,
+                  stway->up ? 'u' : 'd', stway->isladder ? 'l' : 's',
+                  stway->tolev.dnum, stway->tolev.dlevel);
+    for (i = 0; i < g.nroom; i++) {
+        croom = &g.rooms[i];
+        lg_printf("R %d %d %d %d %d %d\n", croom->lx, croom->ly, croom->hx,
+                  croom->hy, croom->rtype, croom->rlit);
+    }
+    for (otmp = fobj; otmp; otmp = otmp->nobj)
+        lg_printf("O %d %d %d %ld %s\n", otmp->ox, otmp->oy, otmp->otyp,
+                  otmp->quan, OBJ_NAME(objects[otmp->otyp]));
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon) {
+        if (DEADMONSTER(mtmp))
+            continue;
+        lg_printf("N %d %d %d %s\n", mtmp->mx, mtmp->my,
+                  monsndx(mtmp->data), mtmp->data->pmnames[NEUTRAL]);
+    }
+    lg_printf("E\n");
+}
+
+/* -w: play the level just made for a while; see the comment at the top */
+static void
+levgen_walk(unsigned long seed)
+{
+    static char travelcmd[2], searchcmd[2] = { 's', '\0' };
+    long lastmove = g.moves + walkturns;
+    stairway *dest = (stairway *) 0;
+    struct monst *mtmp;
+    boolean monscanmove, save_safe_wait = flags.safe_wait;
+
+    u_on_upstairs();
+    vision_reset();
+    check_special_room(FALSE);
+    if (MON_AT(u.ux, u.uy))
+        mnexto(m_at(u.ux, u.uy));
+    (void) makedog();
+    initrack();
+    travelcmd[0] = g.Cmd.spkeys[NHKF_TRAVEL];
+    iflags.debug_fuzzer = TRUE;
+    /* otherwise searching with a monster next to us is refused and no
+       time passes, so a walk blocked by that monster would never end */
+    flags.safe_wait = FALSE;
+    g.program_state.in_moveloop = 1;
+    g.youmonst.movement = NORMAL_SPEED;
+    g.context.move = 0;
+
+    /* falling through a trap door or the like ends the walk rather than
+       going to another level */
+    while (g.moves < lastmove && !u.utotype) {
+        if (g.context.move) {
+            g.youmonst.movement -= NORMAL_SPEED;
+            do {
+                g.context.mon_moving = TRUE;
+                do {
+                    monscanmove = movemon();
+                    if (g.youmonst.movement >= NORMAL_SPEED)
+                        break;
+                } while (monscanmove);
+                g.context.mon_moving = FALSE;
+
+                if (!monscanmove && g.youmonst.movement < NORMAL_SPEED) {
+                    mcalcdistress();
+                    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
+                        mtmp->movement += mcalcmove(mtmp, TRUE);
+                    if (!rn2(70))
+                        (void) makemon((struct permonst *) 0, 0, 0,
+                                       NO_MM_FLAGS);
+                    g.youmonst.movement += g.youmonst.data->mmove;
+                    settrack();
+                    g.monstermoves++;
+                    g.moves++;
+                    nh_timeout();
+                    run_regions();
+                    if (g.multi < 0 && ++g.multi == 0)
+                        unmul((char *) 0);
+                }
+            } while (g.youmonst.movement < NORMAL_SPEED);
+        }
+
+        clear_splitobjs();
+        find_ac();
+        if (g.vision_full_recalc)
+            vision_recalc(0);
+        g.context.move = 1;
+
+        if (g.multi >= 0 && g.occupation) {
+            if ((*g.occupation)() == 0)
+                g.occupation = 0;
+            if (monster_nearby())
+                stop_occupation();
+            continue;
+        }
+        sanity_check();
+        u.umoved = FALSE;
+        if (g.multi > 0) {
+            lookaround();
+            if (!g.multi) {
+                g.context.move = 0;
+                continue;
+            }
+            if (g.context.mv) {
+                if (g.multi < COLNO && !--g.multi)
+                    g.context.travel = g.context.travel1 = g.context.mv =
+                        g.context.run = 0;
+                domove();
+            } else {
+                --g.multi;
+                rhack(g.command_line);
+            }
+        } else if (g.multi == 0) {
+            /* set out for the next staircase once this one is reached */
+            if (!dest || (u.ux == dest->sx && u.uy == dest->sy))
+                dest = (dest && dest->next) ? dest->next : g.stairs;
+            if (dest && (u.ux != dest->sx || u.uy != dest->sy)) {
+                iflags.travelcc.x = u.tx = dest->sx;
+                iflags.travelcc.y = u.ty = dest->sy;
+                g.multi = max(COLNO, ROWNO);
+                u.last_str_turn = 0;
+                rhack(travelcmd);
+            }
+            if (!g.context.move) {
+                /* no way to get any closer; try another one next time */
+                dest = (dest && dest->next) ? dest->next : g.stairs;
+                nomul(0);
+                g.context.move = 1;
+                rhack(searchcmd);
+            }
+        }
+        if (g.vision_full_recalc)
+            vision_recalc(0);
+    }
+
+    iflags.debug_fuzzer = FALSE;
+    flags.safe_wait = save_safe_wait;
+    g.program_state.in_moveloop = 0;
+    g.context.travel = g.context.travel1 = g.context.mv = g.context.run = 0;
+    g.occupation = 0;
+    nomul(0);
+    u.utotype = UTOTYPE_NONE;
+    if (g.dfr_pre_msg)
+        free((genericptr_t) g.dfr_pre_msg), g.dfr_pre_msg = 0;
+    if (g.dfr_post_msg)
+        free((genericptr_t) g.dfr_post_msg), g.dfr_post_msg = 0;
+
+    lg_printf("W %ld %d %d %d\n", g.moves, u.ux, u.uy, u.uhp);
+    levgen_describe(seed);
+}
+
+/* append to the current seed's output; nothing is written anywhere until
+   the seed is finished, so that the farm can hand it over in one go */
+static void
+lg_printf(const char *fmt, ...)
+{
+    va_list the_args;
+    int n;
+
+    if (!obuf)
+        obuf = (char *) alloc((unsigned) (osize = 16 * BUFSZ));
+    for (;;) {
+        va_start(the_args, fmt);
+        n = vsnprintf(obuf + olen, osize - olen, fmt, the_args);
+        va_end(the_args);
+        if (n < 0)
+            panic("%s: output error", progname);
+        if (olen + (size_t) n < osize)
+            break;
+        osize = max(2 * osize, olen + (size_t) n + 1);
+        if (!(obuf = (char *) realloc((genericptr_t) obuf, osize)))
+            panic("%s: out of memory", progname);
+    }
+    olen += (size_t) n;
+}
+
+/* map a seed index onto the seeds given on the command line */
+static unsigned long
+seed_at(unsigned long idx)
+{
+    int i;
+
+    for (i = 0; i < nranges; i++) {
+        if (idx <= ranges[i].hi - ranges[i].lo)
+            return ranges[i].lo + idx;
+        idx -= ranges[i].hi - ranges[i].lo + 1;
+    }
+    panic("%s: seed index out of range", progname);
+    /*NOTREACHED*/
+    return 0;
+}
+
+static void
+run_serial(void)
+{
+    unsigned long idx;
+
+    levgen_init(hackdir);
+    for (idx = 0; idx < nseeds; idx++) {
+        olen = 0;
+        levgen_seed(seed_at(idx));
+        if (olen)
+            (void) fwrite(obuf, 1, olen, outfp);
+    }
+}
+
+/*
+ * Hand out more work to a worker, with farm->lock held.  Chunks from the
+ * queue shrink as it drains; after that, take the unstarted top half of
+ * whichever worker's chunk has the most seeds left.  Seed indices stay
+ * within a short distance of the supervisor's position in the output
+ * either way, which keeps workers from piling up on full ring slots.
+ */
+static boolean
+farm_claim(struct lgworker *me)
+{
+    unsigned long left = nseeds - farm->queued, chunk;
+    struct lgworker *victim = (struct lgworker *) 0;
+    int i;
+
+    if (left) {
+        chunk = left / (unsigned long) (4 * farm->nworkers);
+        chunk = min(chunk, (unsigned long) farm->nslots / farm->nworkers / 2);
+        chunk = max(min(chunk, LGMAXCHUNK), 1UL);
+        me->next = farm->queued;
+        me->end = farm->queued += chunk;
+        return TRUE;
+    }
+    for (i = 0; i < farm->nworkers; i++)
+        if (farm->w[i].end > farm->w[i].next
+            && (!victim || (farm->w[i].end - farm->w[i].next
+                            > victim->end - victim->next)))
+            victim = &farm->w[i];
+    if (!victim)
+        return FALSE;
+    chunk = (victim->end - victim->next + 1) / 2;
+    me->end = victim->end;
+    me->next = victim->end -= chunk;
+    return TRUE;
+}
+
+/* pass the current seed's output to the supervisor through the slot that
+   belongs to its index, a slot-full at a time */
+static void
+farm_put(unsigned long idx)
+{
+    struct lgslot *slot = LGSLOT(idx % farm->nslots);
+    struct timespec ts;
+    size_t off = 0, n;
+
+    do {
+        (void) pthread_mutex_lock(&farm->lock);
+        while (slot->idx != idx || slot->full) {
+            (void) clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += 1;
+            if (pthread_cond_timedwait(&farm->changed, &farm->lock, &ts) != 0
+                && getppid() != farm->supervisor)
+                exit(EXIT_FAILURE); /* nobody left to take the output */
+        }
+        (void) pthread_mutex_unlock(&farm->lock);
+
+        n = min(olen - off, farm->slotsz);
+        (void) memcpy(slot->data, obuf + off, n);
+        slot->len = n;
+        off += n;
+
+        (void) pthread_mutex_lock(&farm->lock);
+        slot->more = (off < olen);
+        slot->full = TRUE;
+        (void) pthread_cond_broadcast(&farm->changed);
+        (void) pthread_mutex_unlock(&farm->lock);
+    } while (off < olen);
+}
+
+static void
+farm_worker(int wn)
+{
+    struct lgworker *me = &farm->w[wn];
+    unsigned long idx;
+
+    levgen_init(hackdir);
+    (void) pthread_mutex_lock(&farm->lock);
+    while (me->next < me->end || farm_claim(me)) {
+        idx = me->next++;
+        (void) pthread_mutex_unlock(&farm->lock);
+        olen = 0;
+        levgen_seed(seed_at(idx));
+        farm_put(idx);
+        (void) pthread_mutex_lock(&farm->lock);
+    }
+    (void) pthread_mutex_unlock(&farm->lock);
+    nh_terminate(EXIT_SUCCESS);
+}
+
+/* a worker which dies takes its claimed seeds with it; give up on the
+   whole run rather than produce output with holes in it */
+static void
+farm_check_workers(pid_t *pids)
+{
+    pid_t pid;
+    int i, status;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (i = 0; i < farm->nworkers; i++)
+            if (pids[i] == pid)
+                pids[i] = 0;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+            continue;
+        (void) fprintf(stderr, "%s: worker %ld failed\n", progname,
+                       (long) pid);
+        for (i = 0; i < farm->nworkers; i++)
+            if (pids[i])
+                (void) kill(pids[i], SIGTERM);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void
+run_farm(int nworkers)
+{
+    pthread_mutexattr_t mattr;
+    pthread_condattr_t cattr;
+    pid_t pids[LGMAXWORKERS];
+    struct lgslot *slot;
+    struct timespec ts;
+    unsigned long idx;
+    size_t farmsz, slotsz, stride;
+    boolean more;
+    int i, nslots, perworker = LGSLOTS_PER_WORKER;
+
+    /* room for all of a seed's output in one slot if that's affordable;
+       otherwise fewer slots per worker, and as a last resort smaller ones */
+    slotsz = (size_t) lgspec_maxlevels() * LGLEVELSZ;
+    if (walkturns > 0L)
+        slotsz *= 2; /* each level is described twice */
+    slotsz = min(slotsz, (size_t) (LGMAXRING / (2 * nworkers)));
+    stride = offsetof(struct lgslot, data) + slotsz;
+    stride = (stride + sizeof (long) - 1) / sizeof (long) * sizeof (long);
+    while (perworker > 2
+           && (long) (perworker * nworkers * stride) > LGMAXRING)
+        perworker /= 2;
+    nslots = perworker * nworkers;
+    farmsz = sizeof (struct lgfarm) + nslots * stride;
+    farm = (struct lgfarm *) mmap((genericptr_t) 0, farmsz,
+                                  PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_ANON, -1, 0);
+    if (farm == (struct lgfarm *) MAP_FAILED) {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    (void) pthread_mutexattr_init(&mattr);
+    (void) pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    (void) pthread_mutex_init(&farm->lock, &mattr);
+    (void) pthread_condattr_init(&cattr);
+    (void) pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    (void) pthread_cond_init(&farm->changed, &cattr);
+    farm->supervisor = getpid();
+    farm->nworkers = nworkers;
+    farm->nslots = nslots;
+    farm->slotsz = slotsz;
+    farm->slotstride = stride;
+    for (i = 0; i < nslots; i++)
+        LGSLOT(i)->idx = (unsigned long) i;
+
+    (void) fflush(outfp); /* don't let the workers inherit buffered output */
+    for (i = 0; i < nworkers; i++) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            perror("fork");
+            exit(EXIT_FAILURE);
+        } else if (!pids[i]) {
+            farm_worker(i);
+            /*NOTREACHED*/
+        }
+    }
+
+    for (idx = 0; idx < nseeds; idx++) {
+        slot = LGSLOT(idx % nslots);
+        do {
+            (void) pthread_mutex_lock(&farm->lock);
+            while (slot->idx != idx || !slot->full) {
+                (void) clock_gettime(CLOCK_REALTIME, &ts);
+                ts.tv_sec += 1;
+                if (pthread_cond_timedwait(&farm->changed, &farm->lock, &ts)
+                    != 0) {
+                    (void) pthread_mutex_unlock(&farm->lock);
+                    farm_check_workers(pids);
+                    (void) pthread_mutex_lock(&farm->lock);
+                }
+            }
+            (void) pthread_mutex_unlock(&farm->lock);
+
+            if (slot->len)
+                (void) fwrite(slot->data, 1, slot->len, outfp);
+
+            (void) pthread_mutex_lock(&farm->lock);
+            more = slot->more;
+            slot->full = FALSE;
+            if (!more)
+                slot->idx = idx + nslots;
+            (void) pthread_cond_broadcast(&farm->changed);
+            (void) pthread_mutex_unlock(&farm->lock);
+        } while (more);
+    }
+    for (i = 0; i < nworkers; i++)
+        if (pids[i])
+            (void) waitpid(pids[i], (int *) 0, 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *outfile = (const char *) 0;
+    unsigned long lo, hi;
+    int i, nworkers = 1;
+
+    if (argc > 0 && argv[0] && *argv[0])
+        progname = argv[0];
+    /* LGNOW is noon here */
+    (void) setenv("TZ", "UTC0", 1);
+    tzset();
+#ifdef HACKDIR
+    hackdir = HACKDIR;
+#endif
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (!argv[i][1] || argv[i][2] || i + 1 >= argc)
+            usage();
+        switch (argv[i][1]) {
+        case 'd':
+            hackdir = argv[++i];
+            break;
+        case 'o':
+            outfile = argv[++i];
+            break;
+        case 'j':
+            nworkers = atoi(argv[++i]);
+            if (nworkers <= 0)
+                nworkers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+            nworkers = max(min(nworkers, LGMAXWORKERS), 1);
+            break;
+        case 'l':
+            parse_levels(argv[++i]);
+            break;
+        case 'q':
+            queryfile = argv[++i];
+            break;
+        case 'w':
+            walkturns = atol(argv[++i]);
+            break;
+        default:
+            usage();
+        }
+    }
+    if (i >= argc)
+        usage();
+    for (; i < argc; i++) {
+        if (!parse_range(argv[i], &lo, &hi))
+            usage();
+        ranges = (struct lgrange *) realloc((genericptr_t) ranges,
+                                            (nranges + 1) * sizeof *ranges);
+        if (!ranges)
+            panic("%s: out of memory", progname);
+        ranges[nranges].lo = lo;
+        ranges[nranges++].hi = hi;
+        nseeds += hi - lo + 1;
+    }
+
+    outfp = stdout;
+    if (outfile && !(outfp = fopen(outfile, "w"))) {
+        perror(outfile);
+        exit(EXIT_FAILURE);
+    }
+    if (nworkers > 1 && nseeds > 1) {
+        run_farm(nworkers);
+        (void) fflush(outfp);
+        if (outfp != stdout)
+            (void) fclose(outfp);
+        exit(EXIT_SUCCESS);
+    }
+    run_serial();
+    (void) fflush(outfp);
+    if (outfp != stdout)
+        (void) fclose(outfp);
+    nh_terminate(EXIT_SUCCESS);
+    /*NOTREACHED*/
+    return 0;
+}
+
+/*levgen.c*/
@@ -0,0 +1,136 @@
+/* NetHack 3.7	nhluac.c	$NHDT-Date$  $NHDT-Branch: NetHack-3.7 $:$NHDT-Revision$ */
+/* NetHack may be freely redistributed.  See license for details. */
+
+/*
+ * nhluac - precompile the lua files in dat/ for the data librarian.
+ *
+ * For each "foo.lua" named on the command line, writes "foo.luac" in the
+ * same directory:  the stamp line from make_luac_stamp() followed by what
+ * lua_dump() makes of the compiled chunk.  nhl_loadchunk() loads that in
+ * place of the source when the stamp matches the running game, so lua's
+ * parser is skipped each time a level, the dungeon or the quest text is
+ * loaded.
+ *
+ * The chunk is given the same name, "(foo.lua)", that the game uses when
+ * it compiles the source itself, and debug information is kept, so lua
+ * error messages and tracebacks look the same either way.  Run it from
+ * the directory the files are in so that the names match.
+ */
+
+#include "config.h"
+#include "dlb.h"
+#include "nhlua.h"
+
+static void xexit(int) NORETURN;
+static int luac_writer(lua_State *, const void *, size_t, void *);
+static int compile(lua_State *, const char *);
+
+static const char *progname = "nhluac";
+
+static void
+xexit(int retcd)
+{
+    exit(retcd);
+    /*NOTREACHED*/
+}
+
+/* lua_dump() callback */
+static int
+luac_writer(lua_State *L UNUSED, const void *p, size_t sz, void *ud)
+{
+    return (fwrite(p, 1, sz, (FILE *) ud) != sz);
+}
+
+/* compile one lua file; returns 0 on success */
+static int
+compile(lua_State *L, const char *fname)
+{
+    FILE *fp;
+    char *buf, *name, stamp[LUAC_STAMPSZ];
+    long buflen;
+    int ret = 1;
+
+    if (!(fp = fopen(fname, RDTMODE))) {
+        perror(fname);
+        return 1;
+    }
+    (void) fseek(fp, 0L, SEEK_END);
+    buflen = ftell(fp);
+    (void) fseek(fp, 0L, SEEK_SET);
+    if (buflen < 0L || !(buf = (char *) malloc((size_t) buflen + 1))) {
+        (void) fprintf(stderr, "%s: can't read %s\n", progname, fname);
+        (void) fclose(fp);
+        return 1;
+    }
+    /* in text mode, fewer bytes than ftell() claimed may come back */
+    buflen = (long) fread(buf, 1, (size_t) buflen, fp);
+    (void) fclose(fp);
+
+    name = (char *) malloc(strlen(fname) + 3); /* 3: '('...')\0' */
+    if (!name) {
+        free(buf);
+        return 1;
+    }
+    Sprintf(name, "(%s)", fname);
+    if (luaL_loadbufferx(L, buf, (size_t) buflen, name, "t") != LUA_OK) {
+        (void) fprintf(stderr, "%s: %s\n", progname, lua_tostring(L, -1));
+        goto done;
+    }
+
+    /* reuse 'name' for the output file */
+    free(name);
+    name = (char *) malloc(strlen(fname) + sizeof LUAC_SUFFIX);
+    if (!name)
+        goto done;
+    Strcat(strcpy(name, fname), LUAC_SUFFIX);
+    if (!(fp = fopen(name, WRBMODE))) {
+        perror(name);
+        goto done;
+    }
+    make_luac_stamp(stamp);
+    if (fputs(stamp, fp) == EOF
+        || lua_dump(L, luac_writer, (void *) fp, 0) != 0) {
+        (void) fprintf(stderr, "%s: error writing %s\n", progname, name);
+        (void) fclose(fp);
+        (void) remove(name);
+        goto done;
+    }
+    if (fclose(fp) == EOF) {
+        perror(name);
+        (void) remove(name);
+        goto done;
+    }
+    ret = 0;
+
+ done:
+    lua_settop(L, 0);
+    free(buf);
+    if (name)
+        free(name);
+    return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+    lua_State *L;
+    int i, errs = 0;
+
+    if (argc > 0 && argv[0] && *argv[0])
+        progname = argv[0];
+    if (argc < 2) {
+        (void) fprintf(stderr, "Usage: %s file.lua ...\n", progname);
+        xexit(EXIT_FAILURE);
+    }
+    if (!(L = luaL_newstate())) {
+        (void) fprintf(stderr, "%s: can't create lua state\n", progname);
+        xexit(EXIT_FAILURE);
+    }
+    for (i = 1; i < argc; ++i)
+        errs += compile(L, argv[i]);
+    lua_close(L);
+
+    xexit(errs ? EXIT_FAILURE : EXIT_SUCCESS);
+    /*NOTREACHED*/
+    return 0;
+}
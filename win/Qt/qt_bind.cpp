@@ -1024,6 +1024,7 @@ struct window_procs Qt_procs = {
 #endif
     nethack_qt_::NetHackQtBind::qt_print_glyph,
     //NetHackQtBind::qt_print_glyph_compose,
+    genl_print_glyph_run,
     nethack_qt_::NetHackQtBind::qt_raw_print,
     nethack_qt_::NetHackQtBind::qt_raw_print_bold,
     nethack_qt_::NetHackQtBind::qt_nhgetch,
@@ -281,6 +281,18 @@ const glyph_info *bkglyphinfo;
     (*cibase->nprocs->win_print_glyph)(cibase->ndata, window, x, y, glyphinfo, bkglyphinfo);
 }
 
+void
+chainin_print_glyph_run(window, x, y, count, glyphinfo, bkglyphinfo)
+winid window;
+xchar x, y;
+int count;
+const glyph_info *glyphinfo;
+const glyph_info *bkglyphinfo;
+{
+    (*cibase->nprocs->win_print_glyph_run)(cibase->ndata, window, x, y, count,
+                                           glyphinfo, bkglyphinfo);
+}
+
 void
 chainin_raw_print(str)
 const char *str;
@@ -536,8 +548,9 @@ struct window_procs chainin_procs = {
 #ifdef POSITIONBAR
     chainin_update_positionbar,
 #endif
-    chainin_print_glyph, chainin_raw_print, chainin_raw_print_bold,
-    chainin_nhgetch, chainin_nh_poskey, chainin_nhbell,
+    chainin_print_glyph, chainin_print_glyph_run, chainin_raw_print,
+    chainin_raw_print_bold, chainin_nhgetch, chainin_nh_poskey,
+    chainin_nhbell,
     chainin_doprev_message, chainin_yn_function, chainin_getlin,
     chainin_get_ext_cmd, chainin_number_pad, chainin_delay_output,
 #ifdef CHANGE_COLOR
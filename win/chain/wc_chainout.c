@@ -347,6 +347,21 @@ const glyph_info *bkglyphinfo;
     (*tdp->nprocs->win_print_glyph)(window, x, y, glyphinfo, bkglyphinfo);
 }
 
+void
+chainout_print_glyph_run(vp, window, x, y, count, glyphinfo, bkglyphinfo)
+void *vp;
+winid window;
+xchar x, y;
+int count;
+const glyph_info *glyphinfo;
+const glyph_info *bkglyphinfo;
+{
+    struct chainout_data *tdp = vp;
+
+    (*tdp->nprocs->win_print_glyph_run)(window, x, y, count, glyphinfo,
+                                        bkglyphinfo);
+}
+
 void
 chainout_raw_print(vp, str)
 void *vp;
@@ -670,8 +685,9 @@ struct chain_procs chainout_procs = {
 #ifdef POSITIONBAR
     chainout_update_positionbar,
 #endif
-    chainout_print_glyph, chainout_raw_print, chainout_raw_print_bold,
-    chainout_nhgetch, chainout_nh_poskey, chainout_nhbell,
+    chainout_print_glyph, chainout_print_glyph_run, chainout_raw_print,
+    chainout_raw_print_bold, chainout_nhgetch, chainout_nh_poskey,
+    chainout_nhbell,
     chainout_doprev_message, chainout_yn_function, chainout_getlin,
     chainout_get_ext_cmd, chainout_number_pad, chainout_delay_output,
 #ifdef CHANGE_COLOR
@@ -594,6 +594,31 @@ const glyph_info *bkglyphinfo;
     POST;
 }
 
+void
+trace_print_glyph_run(vp, window, x, y, count, glyphinfo, bkglyphinfo)
+void *vp;
+winid window;
+xchar x, y;
+int count;
+const glyph_info *glyphinfo;
+const glyph_info *bkglyphinfo;
+{
+    struct trace_data *tdp = vp;
+    int i;
+
+    fprintf(wc_tracelogf, "%sprint_glyph_run(%d, %d, %d, %d:", INDENT,
+            window, x, y, count);
+    for (i = 0; i < count; ++i)
+        fprintf(wc_tracelogf, " %d/%d", glyphinfo[i].glyph,
+                bkglyphinfo[i].glyph);
+    fprintf(wc_tracelogf, ")\n");
+
+    PRE;
+    (*tdp->nprocs->win_print_glyph_run)(tdp->ndata, window, x, y, count,
+                                        glyphinfo, bkglyphinfo);
+    POST;
+}
+
 void
 trace_raw_print(vp, str)
 void *vp;
@@ -1149,7 +1174,8 @@ struct chain_procs trace_procs = {
 #ifdef POSITIONBAR
     trace_update_positionbar,
 #endif
-    trace_print_glyph, trace_raw_print, trace_raw_print_bold, trace_nhgetch,
+    trace_print_glyph, trace_print_glyph_run, trace_raw_print,
+    trace_raw_print_bold, trace_nhgetch,
     trace_nh_poskey, trace_nhbell, trace_doprev_message, trace_yn_function,
     trace_getlin, trace_get_ext_cmd, trace_number_pad, trace_delay_output,
 #ifdef CHANGE_COLOR
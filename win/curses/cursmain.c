@@ -80,6 +80,7 @@ struct window_procs curses_procs = {
     dummy_update_position_bar,
 #endif
     curses_print_glyph,
+    genl_print_glyph_run,
     curses_raw_print,
     curses_raw_print_bold,
     curses_nhgetch,
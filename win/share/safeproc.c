@@ -83,8 +83,9 @@ struct window_procs safe_procs = {
 #ifdef POSITIONBAR
     safe_update_positionbar,
 #endif
-    safe_print_glyph, safe_raw_print, safe_raw_print_bold, safe_nhgetch,
-    safe_nh_poskey, safe_nhbell, safe_doprev_message, safe_yn_function,
+    safe_print_glyph, safe_print_glyph_run, safe_raw_print,
+    safe_raw_print_bold, safe_nhgetch, safe_nh_poskey, safe_nhbell,
+    safe_doprev_message, safe_yn_function,
     safe_getlin, safe_get_ext_cmd, safe_number_pad, safe_delay_output,
 #ifdef CHANGE_COLOR /* the Mac uses a palette device */
     safe_change_color,
@@ -309,6 +310,23 @@ safe_print_glyph(
     return;
 }
 
+/*
+ *  safe_print_glyph_run
+ *
+ *  Print a run of glyphs along a row.  Don't flush the output device.
+ */
+void
+safe_print_glyph_run(
+    winid window UNUSED,
+    xchar x UNUSED,
+    xchar y UNUSED,
+    int count UNUSED,
+    const glyph_info *glyphinfo UNUSED,
+    const glyph_info *bkglyphinfo UNUSED)
+{
+    return;
+}
+
 void
 safe_raw_print(const char *str)
 {
@@ -208,7 +208,8 @@ struct window_procs shim_procs = {
 #ifdef POSITIONBAR
     shim_update_positionbar,
 #endif
-    shim_print_glyph, shim_raw_print, shim_raw_print_bold, shim_nhgetch,
+    shim_print_glyph, genl_print_glyph_run, shim_raw_print,
+    shim_raw_print_bold, shim_nhgetch,
     shim_nh_poskey, shim_nhbell, shim_doprev_message, shim_yn_function,
     shim_getlin, shim_get_ext_cmd, shim_number_pad, shim_delay_output,
 #ifdef CHANGE_COLOR /* the Mac uses a palette device */
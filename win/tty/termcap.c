@@ -534,6 +534,34 @@ nocmov(int x, int y)
     }
 }
 
+/* would nocmov(x, y) send fewer bytes than cmov(x, y)? */
+boolean
+nocmov_cheaper(int x, int y)
+{
+    int dy = y - (int) ttyDisplay->cury, dx = x - (int) ttyDisplay->curx,
+        cost = 0;
+
+    if (!nh_CM)
+        return TRUE;
+    if (dy < 0) {
+        if (!UP)
+            return FALSE;
+        cost += -dy * (int) strlen(UP);
+    } else if (dy > 0) {
+        if (!XD)
+            return FALSE;
+        cost += dy * (int) strlen(XD);
+    }
+    if (dx > 0) {
+        if (!nh_ND)
+            return FALSE;
+        cost += dx * (int) strlen(nh_ND);
+    } else if (dx < 0) {
+        cost += -dx * (int) strlen(BC);
+    }
+    return (boolean) (cost <= (int) strlen(tgoto(nh_CM, x, y)));
+}
+
 void
 cmov(register int x, register int y)
 {
@@ -115,7 +115,8 @@ struct window_procs tty_procs = {
 #ifdef POSITIONBAR
     tty_update_positionbar,
 #endif
-    tty_print_glyph, tty_raw_print, tty_raw_print_bold, tty_nhgetch,
+    tty_print_glyph, tty_print_glyph_run, tty_raw_print, tty_raw_print_bold,
+    tty_nhgetch,
     tty_nh_poskey, tty_nhbell, tty_doprev_message, tty_yn_function,
     tty_getlin, tty_get_ext_cmd, tty_number_pad, tty_delay_output,
 #ifdef CHANGE_COLOR /* the Mac uses a palette device */
@@ -146,8 +147,16 @@ struct DisplayDesc *ttyDisplay; /* the tty display descriptor */
 
 extern void cmov(int, int);   /* from termcap.c */
 extern void nocmov(int, int); /* from termcap.c */
+#ifndef NO_TERMS
+extern boolean nocmov_cheaper(int, int); /* from termcap.c */
+#else
+#define nocmov_cheaper(x, y) TRUE
+#endif
 #if defined(UNIX) || defined(VMS)
-static char obuf[BUFSIZ]; /* BUFSIZ is defined in stdio.h */
+/* room for a full screen redraw, colors included, so that a frame is
+   normally sent with one write() when stdout gets flushed */
+#define TTY_OBUFSIZ (32 * 1024)
+static char obuf[TTY_OBUFSIZ];
 #endif
 
 static char winpanicstr[] = "Bad window id %d";
@@ -199,6 +208,7 @@ static void process_text_window(winid, struct WinDesc *);
 static tty_menu_item *reverse(tty_menu_item *);
 static const char *compress_str(const char *);
 static void tty_putsym(winid, int, int, char);
+static void tty_putglyph(winid, const glyph_info *);
 static void setup_rolemenu(winid, boolean, int, int, int);
 static void setup_racemenu(winid, boolean, int, int, int);
 static void setup_gendmenu(winid, boolean, int, int, int);
@@ -418,7 +428,7 @@ tty_init_nhwindows(int *argcp UNUSED, char **argv UNUSED)
      *    due to ordering of graphics settings
      */
 #if defined(UNIX) || defined(VMS)
-    setbuf(stdout, obuf);
+    (void) setvbuf(stdout, obuf, _IOFBF, sizeof obuf);
 #endif
     gettty();
 
@@ -2540,7 +2550,7 @@ tty_curs(winid window,
         cy = -cy;
     if ((cx -= x) < 0)
         cx = -cx;
-    if (cy <= 3 && cx <= 3) {
+    if (cy <= 3 && cx <= 3 && nocmov_cheaper(x, y)) {
         nocmov(x, y);
 #ifndef NO_TERMS
     } else if ((x <= 3 && cy <= 3) || (!nh_CM && x < cx)) {
@@ -3339,23 +3349,9 @@ tty_cliparound(int x, int y)
 }
 #endif /* CLIPPING */
 
-/*
- *  tty_print_glyph
- *
- *  Print the glyph to the output device.  Don't flush the output device.
- *
- *  Since this is only called from show_glyph(), it is assumed that the
- *  position and glyph are always correct (checked there)!
- */
-
-void
-tty_print_glyph(winid window, xchar x, xchar y,
-#if defined(TTY_TILES_ESCCODES) || defined(MSDOS)
-                const glyph_info *glyphinfo,
-#else
-                const glyph_info *glyphinfo UNUSED,
-#endif
-                const glyph_info *bkglyphinfo UNUSED)
+/* output one map glyph at the current cursor position of window */
+static void
+tty_putglyph(winid window, const glyph_info *glyphinfo)
 {
     boolean inverse_on = FALSE;
     int ch, color;
@@ -3364,13 +3360,6 @@ tty_print_glyph(winid window, xchar x, xchar y,
 #endif
     unsigned special;
 
-    HUPSKIP();
-#ifdef CLIPPING
-    if (clipping) {
-        if (x <= clipx || y < clipy || x >= clipxmax || y >= clipymax)
-            return;
-    }
-#endif
     /* get glyph ttychar, color, and special flags */
 #if defined(TTY_TILES_ESCCODES) || defined(MSDOS)
     glyph = glyphinfo->glyph;
@@ -3379,11 +3368,6 @@ tty_print_glyph(winid window, xchar x, xchar y,
     color = glyphinfo->color;
     special = glyphinfo->glyphflags;
 
-    print_vt_code2(AVTC_SELECT_WINDOW, window);
-
-    /* Move the cursor. */
-    tty_curs(window, x, y);
-
     print_vt_code3(AVTC_GLYPH_START, glyph2tile[glyph], special);
 
 #ifndef NO_TERMS
@@ -3448,6 +3432,74 @@ tty_print_glyph(winid window, xchar x, xchar y,
     ttyDisplay->curx++;   /* the real cursor moved too */
 }
 
+/*
+ *  tty_print_glyph
+ *
+ *  Print the glyph to the output device.  Don't flush the output device.
+ *
+ *  Since this is only called from show_glyph(), it is assumed that the
+ *  position and glyph are always correct (checked there)!
+ */
+
+void
+tty_print_glyph(winid window, xchar x, xchar y,
+                const glyph_info *glyphinfo,
+                const glyph_info *bkglyphinfo UNUSED)
+{
+    HUPSKIP();
+#ifdef CLIPPING
+    if (clipping) {
+        if (x <= clipx || y < clipy || x >= clipxmax || y >= clipymax)
+            return;
+    }
+#endif
+    print_vt_code2(AVTC_SELECT_WINDOW, window);
+
+    /* Move the cursor. */
+    tty_curs(window, x, y);
+
+    tty_putglyph(window, glyphinfo);
+}
+
+/*
+ *  tty_print_glyph_run
+ *
+ *  Print count adjacent glyphs on row y starting at column x.  The cursor
+ *  is only positioned once; each glyph advances it by one, so the run goes
+ *  out as a single stretch of characters with color changes only where
+ *  the color actually differs.  Don't flush the output device.
+ */
+void
+tty_print_glyph_run(winid window, xchar x, xchar y, int count,
+                    const glyph_info *glyphinfo,
+                    const glyph_info *bkglyphinfo UNUSED)
+{
+    int i, end = x + count;
+
+    HUPSKIP();
+    i = x;
+#ifdef CLIPPING
+    if (clipping) {
+        if (y < clipy || y >= clipymax)
+            return;
+        if (i <= clipx)
+            i = clipx + 1;
+        if (end > clipxmax)
+            end = clipxmax;
+    }
+#endif
+    if (i >= end)
+        return;
+
+    print_vt_code2(AVTC_SELECT_WINDOW, window);
+
+    /* Move the cursor once for the whole run. */
+    tty_curs(window, i, y);
+
+    for (; i < end; ++i)
+        tty_putglyph(window, &glyphinfo[i - x]);
+}
+
 void
 tty_raw_print(const char *str)
 {
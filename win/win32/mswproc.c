@@ -107,7 +107,8 @@ struct window_procs mswin_procs = {
 #ifdef POSITIONBAR
     donull,
 #endif
-    mswin_print_glyph, mswin_raw_print, mswin_raw_print_bold, mswin_nhgetch,
+    mswin_print_glyph, genl_print_glyph_run, mswin_raw_print,
+    mswin_raw_print_bold, mswin_nhgetch,
     mswin_nh_poskey, mswin_nhbell, mswin_doprev_message, mswin_yn_function,
     mswin_getlin, mswin_get_ext_cmd, mswin_number_pad, mswin_delay_output,
 #ifdef CHANGE_COLOR /* only a Mac option currently */